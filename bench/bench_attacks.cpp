@@ -0,0 +1,113 @@
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/engine/attacks/attacks.h"
+#include "../src/engine/masks/masks.h"
+#include "bench_lib.h"
+
+// The rook table replaced by the packed one, 4096 entries for every square
+struct FixedRookTable {
+    Bitboard masks[64];
+    Bitboard attacks[64][4096];
+
+    FixedRookTable() {
+        for (int index = 0; index < 64; index++) {
+            Square square = static_cast<Square>(index);
+            masks[square] = generateSingleRookRelevantOccupanciesMask(square);
+            for (int subset = 0; subset < 1 << masks[square].popCount();
+                 subset++) {
+                Bitboard occupancy = setOccupancy(subset, masks[square]);
+                attacks[square][lookupIndex(square, occupancy)] =
+                    generateSingleRookAttacks(square, occupancy);
+            }
+        }
+    }
+
+    uint64_t lookupIndex(Square square, Bitboard occupancies) const {
+        return ((occupancies & masks[square]).getValue() *
+                rookMagicNumbers[square]) >>
+               (64 - rookRelevantOccupanciesCounts[square]);
+    }
+
+    Bitboard lookup(Square square, Bitboard occupancies) const {
+        return attacks[square][lookupIndex(square, occupancies)];
+    }
+};
+
+void run_attack_benchmarks() {
+    // Sparse random boards, so the lookups spread over the whole tables
+    std::mt19937_64 random(1804289383);
+    std::vector<Bitboard> occupancies;
+    for (int count = 0; count < 64; count++) {
+        occupancies.push_back(Bitboard(random() & random() & random()));
+    }
+    auto magicTables = buildAttackTables(MAGIC_BACKEND);
+    auto fixed = std::make_unique<FixedRookTable>();
+    const uint64_t iterations = 20000;
+
+    std::cout << "Rook attacks, 64 squares x " << occupancies.size()
+              << " occupancies per op" << std::endl;
+    std::cout << "  fixed " << sizeof(fixed->attacks) / 1024
+              << " KB, packed "
+              << sizeof(magicTables->sliderAttacks) / 1024
+              << " KB for rooks and bishops" << std::endl;
+
+    const AttackTables& magics = *magicTables;
+    auto rooks = [&](bool packed) {
+        return [&, packed](uint64_t count) {
+            uint64_t squares = 0;
+            for (uint64_t iteration = 0; iteration < count; iteration++) {
+                for (Bitboard occupancy : occupancies) {
+                    for (int index = 0; index < 64; index++) {
+                        Square square = static_cast<Square>(index);
+                        Bitboard attacks =
+                            packed ? rookAttacks(magics, square, occupancy)
+                                   : fixed->lookup(square, occupancy);
+                        squares += attacks.getValue();
+                    }
+                }
+            }
+            return squares;
+        };
+    };
+
+    double fixedRooks =
+        benchmark("[64][4096] table", iterations, rooks(false));
+    double packedRooks =
+        benchmark("packed fancy magics", iterations, rooks(true));
+    benchmarkSpeedup(fixedRooks, packedRooks);
+
+    if (!isPextSupported()) {
+        std::cout << "  PEXT backend not available" << std::endl;
+        return;
+    }
+
+    auto pextTables = buildAttackTables(PEXT_BACKEND);
+
+    std::cout << "Slider attacks per backend, bishop and rook" << std::endl;
+
+    auto sliders = [&](const AttackTables& backendTables) {
+        return [&](uint64_t count) {
+            uint64_t squares = 0;
+            for (uint64_t iteration = 0; iteration < count; iteration++) {
+                for (Bitboard occupancy : occupancies) {
+                    for (int index = 0; index < 64; index++) {
+                        Square square = static_cast<Square>(index);
+                        squares += (bishopAttacks(backendTables, square,
+                                                  occupancy) |
+                                    rookAttacks(backendTables, square,
+                                                occupancy))
+                                       .getValue();
+                    }
+                }
+            }
+            return squares;
+        };
+    };
+
+    double magic = benchmark("magic", iterations, sliders(*magicTables));
+    double pext = benchmark("PEXT", iterations, sliders(*pextTables));
+    benchmarkSpeedup(magic, pext);
+}
@@ -0,0 +1,17 @@
+#include "bench_lib.h"
+
+volatile uint64_t benchmarkSink = 0;
+
+const std::vector<std::string> benchmarkFens = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+};
+
+void benchmarkSpeedup(double baseline, double candidate) {
+    std::cout << "  " << std::left << std::setw(40) << "speedup" << std::right
+              << std::fixed << std::setprecision(2) << std::setw(10)
+              << baseline / candidate << "x" << std::endl;
+}
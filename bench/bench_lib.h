@@ -0,0 +1,38 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Folded into every benchmark result so the measured work is not optimised
+// away
+extern volatile uint64_t benchmarkSink;
+
+/*
+  Calls run(iterations) once to warm up and once timed, printing and
+  returning the nanoseconds per iteration. run does its own loop, so the
+  call overhead is paid once per measure and not per iteration.
+*/
+template <typename Run>
+double benchmark(const std::string& name, uint64_t iterations, Run run) {
+    benchmarkSink = benchmarkSink + run(iterations / 10 + 1);
+
+    auto start = std::chrono::steady_clock::now();
+    benchmarkSink = benchmarkSink + run(iterations);
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+    double nsPerIteration = (double)elapsed / iterations;
+    std::cout << "  " << std::left << std::setw(40) << name << std::right
+              << std::fixed << std::setprecision(2) << std::setw(10)
+              << nsPerIteration << " ns/op" << std::endl;
+    return nsPerIteration;
+}
+
+void benchmarkSpeedup(double baseline, double candidate);
+
+// Fixed positions shared by the benchmarks, the perft test positions
+extern const std::vector<std::string> benchmarkFens;
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "../src/engine/engine.h"
+#include "bench_lib.h"
+
+// The std::map lookups replaced by constexpr arrays, kept as baselines
+const std::map<std::pair<Color, Piece>, PieceBoard> sideColorToPieceBoardMap =
+    [] {
+        std::map<std::pair<Color, Piece>, PieceBoard> map;
+        for (int pieceBoard = 0; pieceBoard < 12; pieceBoard++) {
+            map[pieceBoardToSideColor[pieceBoard]] =
+                static_cast<PieceBoard>(pieceBoard);
+        }
+        return map;
+    }();
+
+const std::map<Piece, int> materialScoreMap = {
+    {PAWN, 100}, {KNIGHT, 300}, {BISHOP, 350},
+    {ROOK, 500}, {QUEEN, 1000}, {KING, 10000},
+};
+
+int mapMaterialScore(const ChessboardStatus& status) {
+    int score = 0;
+    for (int bbIndex = 0; bbIndex < 12; bbIndex++) {
+        Bitboard bitboard = status.boards[bbIndex];
+        while (!bitboard.isEmpty()) {
+            auto [side, piece] = pieceBoardToSideColor[bbIndex];
+            int pieceScore = materialScoreMap.at(piece);
+            score += (side == WHITE) ? +pieceScore : -pieceScore;
+            bitboard.clearBit(bitboard.leastSignificantBeatIndex());
+        }
+    }
+    return score;
+}
+
+void run_lookup_benchmarks() {
+    Engine engine;
+    engine.init();
+    std::vector<ChessboardStatus> positions;
+    for (const auto& fen : benchmarkFens) {
+        engine.parseFEN(fen);
+        positions.push_back(engine.board.status);
+    }
+    const uint64_t iterations = 200000;
+
+    std::cout << "Piece board lookup, 12 per op" << std::endl;
+
+    auto pieceBoards = [&](bool map) {
+        return [map](uint64_t count) {
+            uint64_t boards = 0;
+            for (uint64_t iteration = 0; iteration < count; iteration++) {
+                for (int color = WHITE; color <= BLACK; color++) {
+                    for (int piece = PAWN; piece < EMPTY; piece++) {
+                        Color side = static_cast<Color>(color);
+                        Piece type = static_cast<Piece>(piece);
+                        boards += map ? sideColorToPieceBoardMap.at(
+                                            {side, type})
+                                      : pieceBoardOf(type, side);
+                    }
+                }
+            }
+            return boards;
+        };
+    };
+
+    double mapBoards = benchmark("std::map", iterations, pieceBoards(true));
+    double tableBoards =
+        benchmark("constexpr array", iterations, pieceBoards(false));
+    benchmarkSpeedup(mapBoards, tableBoards);
+
+    std::cout << "Material evaluation, " << positions.size()
+              << " positions per op" << std::endl;
+
+    auto material = [&](bool map) {
+        return [&, map](uint64_t count) {
+            uint64_t score = 0;
+            for (uint64_t iteration = 0; iteration < count; iteration++) {
+                for (const auto& position : positions) {
+                    engine.board.status = position;
+                    score += map ? mapMaterialScore(position)
+                                 : engine.evaluateMaterialScore();
+                }
+            }
+            return score;
+        };
+    };
+
+    double mapMaterial =
+        benchmark("std::map", iterations / 10, material(true));
+    double tableMaterial =
+        benchmark("constexpr array", iterations / 10, material(false));
+    benchmarkSpeedup(mapMaterial, tableMaterial);
+}
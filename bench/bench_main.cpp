@@ -0,0 +1,22 @@
+#include <iostream>
+
+#include "../src/lib/logger/logger.h"
+
+// Forward declarations of benchmark functions
+void run_movegen_benchmarks();
+void run_move_benchmarks();
+void run_lookup_benchmarks();
+void run_attack_benchmarks();
+void run_search_benchmarks();
+
+int main() {
+    logger.configure(LoggerProps{enabled : false});
+
+    std::cout << "Khez Chess Engine - Benchmarks" << std::endl;
+    run_movegen_benchmarks();
+    run_move_benchmarks();
+    run_lookup_benchmarks();
+    run_attack_benchmarks();
+    run_search_benchmarks();
+    return 0;
+}
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "../src/engine/engine.h"
+#include "bench_lib.h"
+
+// The decoding replaced by the move type table, a std::map keyed by the
+// decoded fields
+MoveType mapLookupMoveType(u_int32_t binary) {
+    static const std::map<std::tuple<Piece, Piece, bool, bool, bool, bool>,
+                          MoveType>
+        moveTypeMap = [] {
+            std::map<std::tuple<Piece, Piece, bool, bool, bool, bool>,
+                     MoveType>
+                map;
+            for (int type = KING_CAPTURE; type >= PAWN_PUSH; type--) {
+                Move move(a1, a2, static_cast<MoveType>(type));
+                map[{move.piece, move.promoted, move.isCapture,
+                     move.isDoublePush, move.isEnpassant, move.isCastling}] =
+                    static_cast<MoveType>(type);
+            }
+            return map;
+        }();
+
+    Square to = static_cast<Square>((binary >> 6) & 0x3f);
+    auto key = std::make_tuple(static_cast<Piece>((binary >> 12) & 0xf),
+                               static_cast<Piece>((binary >> 16) & 0xf),
+                               bool((binary >> 20) & 1),
+                               bool((binary >> 21) & 1),
+                               bool((binary >> 22) & 1),
+                               bool((binary >> 23) & 1));
+    auto found = moveTypeMap.find(key);
+    MoveType type = found != moveTypeMap.end() ? found->second : PAWN_PUSH;
+    if (std::get<5>(key) && (to == c8 || to == c1)) {
+        type = CASTLE_QUEENSIDE;
+    }
+    return type;
+}
+
+void run_move_benchmarks() {
+    Engine engine;
+    engine.init();
+    std::vector<u_int32_t> moves;
+    for (const auto& fen : benchmarkFens) {
+        engine.parseFEN(fen);
+        for (u_int32_t move : engine.generateLegalMoves()) {
+            moves.push_back(move);
+        }
+    }
+    const uint64_t iterations = 20000;
+
+    std::cout << "Move decoding, " << moves.size() << " moves per op"
+              << std::endl;
+
+    auto decode = [&](bool mapLookup) {
+        return [&, mapLookup](uint64_t count) {
+            uint64_t types = 0;
+            for (uint64_t iteration = 0; iteration < count; iteration++) {
+                for (u_int32_t move : moves) {
+                    types += mapLookup ? mapLookupMoveType(move)
+                                       : Move(move).type;
+                }
+            }
+            return types;
+        };
+    };
+
+    double mapLookup = benchmark("std::map lookup", iterations, decode(true));
+    double table = benchmark("move type table", iterations, decode(false));
+    benchmarkSpeedup(mapLookup, table);
+
+    std::cout << "Move encoding, " << moves.size() << " moves per op"
+              << std::endl;
+
+    std::vector<Move> decoded(moves.begin(), moves.end());
+    benchmark("Move::createBinary", iterations, [&](uint64_t count) {
+        uint64_t binaries = 0;
+        for (uint64_t iteration = 0; iteration < count; iteration++) {
+            for (const Move& move : decoded) {
+                binaries += Move::createBinary(move.from, move.to, move.type);
+            }
+        }
+        return binaries;
+    });
+}
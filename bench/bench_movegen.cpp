@@ -0,0 +1,54 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../src/engine/engine.h"
+#include "bench_lib.h"
+
+// The benchmark positions and every position one ply after them
+std::vector<ChessboardStatus> benchmarkPositions(Engine& engine) {
+    std::vector<ChessboardStatus> positions;
+    for (const auto& fen : benchmarkFens) {
+        engine.parseFEN(fen);
+        positions.push_back(engine.board.status);
+        for (u_int32_t move : engine.generateLegalMoves()) {
+            engine.board.makePsuedoLegalMove(Move(move));
+            positions.push_back(engine.board.status);
+            engine.undoMove();
+        }
+    }
+    return positions;
+}
+
+void run_movegen_benchmarks() {
+    Engine engine;
+    engine.init();
+    std::vector<ChessboardStatus> positions = benchmarkPositions(engine);
+    const uint64_t iterations = 2000;
+
+    std::cout << "Pawn move generation, " << positions.size()
+              << " positions per op" << std::endl;
+
+    auto pawnMoves = [&](bool perSquare) {
+        return [&, perSquare](uint64_t count) {
+            uint64_t generated = 0;
+            for (const auto& position : positions) {
+                engine.board.status = position;
+                for (uint64_t iteration = 0; iteration < count; iteration++) {
+                    MoveList moves;
+                    if (perSquare) {
+                        engine.generatePawnMovesPerSquare(moves);
+                    } else {
+                        engine.generatePawnMoves(moves);
+                    }
+                    generated += moves.size();
+                }
+            }
+            return generated;
+        };
+    };
+
+    double perSquare = benchmark("per square", iterations, pawnMoves(true));
+    double setWise = benchmark("set-wise", iterations, pawnMoves(false));
+    benchmarkSpeedup(perSquare, setWise);
+}
@@ -0,0 +1,53 @@
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+#include "../src/engine/engine.h"
+#include "bench_lib.h"
+
+// Searches from scratch, without tables or history from earlier searches
+uint64_t searchNodes(Engine& engine, const std::string& fen, int depth) {
+    engine.transpositionTable->clear();
+    std::fill(&engine.history[0][0][0], &engine.history[0][0][0] + 2 * 64 * 64,
+              0);
+    engine.parseFEN(fen);
+    engine.searchBestMove(depth);
+    return engine.nodes;
+}
+
+void run_search_benchmarks() {
+    Engine engine;
+    engine.init();
+    const int depth = 6;
+
+    std::cout << "Search to depth " << depth << std::endl;
+
+    double logBranchingFactors = 0;
+    SearchStats total;
+    uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const auto& fen : benchmarkFens) {
+        uint64_t previous = searchNodes(engine, fen, depth - 1);
+        uint64_t last = searchNodes(engine, fen, depth);
+
+        // Iterative deepening to depth over the one to depth - 1
+        logBranchingFactors += std::log((double)last / previous);
+        total.betaCutoffs += engine.stats.betaCutoffs;
+        total.firstMoveCutoffs += engine.stats.firstMoveCutoffs;
+        totalNodes += last;
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+
+    std::cout << std::fixed << std::setprecision(2) << "  nodes "
+              << totalNodes << ", time " << elapsed << "ms" << std::endl
+              << "  effective branching factor "
+              << std::exp(logBranchingFactors / benchmarkFens.size())
+              << std::endl
+              << "  first move cutoffs " << total.firstMoveCutoffRate() * 100
+              << "% of " << total.betaCutoffs << std::endl;
+}
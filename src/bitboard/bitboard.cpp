@@ -97,6 +97,11 @@ Bitboard& Bitboard::operator&=(const Bitboard& other) {
     return *this;
 }
 
+Bitboard& Bitboard::operator^=(const Bitboard& other) {
+    board_ ^= other.board_;
+    return *this;
+}
+
 bool Bitboard::operator==(const Bitboard& other) const {
     return board_ == other.board_;
 }
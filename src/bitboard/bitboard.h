@@ -31,6 +31,7 @@ class Bitboard {
 
     Bitboard& operator|=(const Bitboard& other);
     Bitboard& operator&=(const Bitboard& other);
+    Bitboard& operator^=(const Bitboard& other);
 
     bool operator==(const Bitboard& other) const;
     bool operator!=(const Bitboard& other) const;
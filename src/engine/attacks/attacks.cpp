@@ -0,0 +1,523 @@
+#include "attacks.h"
+
+#include <cassert>
+
+#include "../chessboard/sliding-piece.h"
+#include "../masks/masks.h"
+
+#pragma region pawns
+
+Bitboard generateSinglePawnMaskAttacks(Square square, Color color) {
+    Bitboard squareBitboard;
+    squareBitboard.setBit(square);
+
+    Bitboard attacks;
+
+    if (color == WHITE) {
+        attacks |= whitePawnWestAttack(squareBitboard);
+        attacks |= whitePawnEastAttack(squareBitboard);
+    } else {
+        attacks |= blackPawnWestAttack(squareBitboard);
+        attacks |= blackPawnEastAttack(squareBitboard);
+    }
+
+    return attacks;
+}
+
+void generatePawnMaskAttacks(AttackTables& tables) {
+    for (int square = 0; square < 64; square++) {
+        tables.pawnAttacksMasks[WHITE][square] =
+            generateSinglePawnMaskAttacks(static_cast<Square>(square), WHITE);
+        tables.pawnAttacksMasks[BLACK][square] =
+            generateSinglePawnMaskAttacks(static_cast<Square>(square), BLACK);
+    }
+}
+
+#pragma endregion pawns
+
+#pragma region knights
+
+Bitboard knightNoNoEa(Bitboard knight) { return (knight & notHFile) >> 17; }
+Bitboard knightNoEaEa(Bitboard knight) { return (knight & notGHFile) >> 10; }
+Bitboard knightSoEaEa(Bitboard knight) { return (knight & notGHFile) << 6; }
+Bitboard knightSoSoEa(Bitboard knight) { return (knight & notHFile) << 15; }
+Bitboard knightNoNoWe(Bitboard knight) { return (knight & notAFile) >> 15; }
+Bitboard knightNoWeWe(Bitboard knight) { return (knight & notABFile) >> 6; }
+Bitboard knightSoWeWe(Bitboard knight) { return (knight & notABFile) << 10; }
+Bitboard knightSoSoWe(Bitboard knight) { return (knight & notAFile) << 17; }
+
+Bitboard generateSingleKnightAttacksMask(Square square) {
+    Bitboard squareBitboard;
+    squareBitboard.setBit(square);
+
+    Bitboard moves;
+
+    moves |= knightNoNoEa(squareBitboard);
+    moves |= knightNoEaEa(squareBitboard);
+    moves |= knightSoEaEa(squareBitboard);
+    moves |= knightSoSoEa(squareBitboard);
+    moves |= knightNoNoWe(squareBitboard);
+    moves |= knightNoWeWe(squareBitboard);
+    moves |= knightSoWeWe(squareBitboard);
+    moves |= knightSoSoWe(squareBitboard);
+
+    return moves;
+}
+
+void generateKnightMaskMoves(AttackTables& tables) {
+    for (int square = 0; square < 64; square++) {
+        tables.knightAttacksMasks[square] =
+            generateSingleKnightAttacksMask(static_cast<Square>(square));
+    }
+}
+
+#pragma endregion
+
+#pragma region King
+
+Bitboard kingNoWe(Bitboard king) { return (king & notAFile) >> 7; }
+Bitboard kingNo(Bitboard king) { return king >> 8; }
+Bitboard KingNoEa(Bitboard king) { return (king & notHFile) >> 9; }
+Bitboard KingEa(Bitboard king) { return (king & notHFile) >> 1; }
+Bitboard kingSoEa(Bitboard king) { return (king & notHFile) << 7; }
+Bitboard kingSo(Bitboard king) { return king << 8; }
+Bitboard kingSoWe(Bitboard king) { return (king & notAFile) << 9; }
+Bitboard kingWe(Bitboard king) { return (king & notAFile) << 1; }
+
+Bitboard generateSingleKingAttacksMask(Square square) {
+    Bitboard squareBitboard;
+    squareBitboard.setBit(square);
+
+    Bitboard moves;
+    moves |= kingNoWe(squareBitboard);
+    moves |= kingNo(squareBitboard);
+    moves |= KingNoEa(squareBitboard);
+    moves |= KingEa(squareBitboard);
+    moves |= kingSoEa(squareBitboard);
+    moves |= kingSo(squareBitboard);
+    moves |= kingSoWe(squareBitboard);
+    moves |= kingWe(squareBitboard);
+
+    return moves;
+}
+
+void generateKingMaskMoves(AttackTables& tables) {
+    for (int square = 0; square < 64; square++) {
+        tables.kingAttacksMasks[square] =
+            generateSingleKingAttacksMask(static_cast<Square>(square));
+    }
+}
+
+#pragma endregion
+
+#pragma region Bishops
+
+Bitboard northEastRelevantOccupancies(Square square) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank + 1, file = pieceFile + 1; rank <= 6 && file <= 6;
+         rank++, file++) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
+        mask |= tMask;
+    }
+    return mask;
+}
+
+Bitboard southEastRelevantOccupancies(Square square) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank - 1, file = pieceFile + 1; rank >= 1 && file <= 6;
+         rank--, file++) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
+        mask |= tMask;
+    }
+    return mask;
+}
+
+Bitboard northWestRelevantOccupancies(Square square) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank + 1, file = pieceFile - 1; rank <= 6 && file >= 1;
+         rank++, file--) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
+        mask |= tMask;
+    }
+    return mask;
+}
+
+Bitboard southWestRelevantOccupancies(Square square) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank - 1, file = pieceFile - 1; rank >= 1 && file >= 1;
+         rank--, file--) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
+        mask |= tMask;
+    }
+    return mask;
+}
+
+Bitboard generateSingleBishopRelevantOccupanciesMask(Square square) {
+    Bitboard mask;
+    mask |= northEastRelevantOccupancies(square);
+    mask |= southEastRelevantOccupancies(square);
+    mask |= northWestRelevantOccupancies(square);
+    mask |= southWestRelevantOccupancies(square);
+
+    return mask;
+}
+
+Bitboard bishopNorthEastAttacks(Square square, Bitboard blocks) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank + 1, file = pieceFile + 1; rank < 8 && file < 8;
+         rank++, file++) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
+        mask |= tMask;
+
+        if (!(blocks & tMask).isEmpty()) {
+            break;
+        }
+    }
+    return mask;
+}
+
+Bitboard bishopSouthEastAttacks(Square square, Bitboard blocks) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank - 1, file = pieceFile + 1; rank >= 0 && file < 8;
+         rank--, file++) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
+        mask |= tMask;
+
+        if (!(blocks & tMask).isEmpty()) {
+            break;
+        }
+    }
+
+    return mask;
+}
+
+Bitboard bishopNorthWestAttacks(Square square, Bitboard blocks) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank + 1, file = pieceFile - 1; rank < 8 && file >= 0;
+         rank++, file--) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
+        mask |= tMask;
+
+        if (!(blocks & tMask).isEmpty()) {
+            break;
+        }
+    }
+    return mask;
+}
+
+Bitboard bishopSouthWestAttacks(Square square, Bitboard blocks) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank - 1, file = pieceFile - 1; rank >= 0 && file >= 0;
+         rank--, file--) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
+        mask |= tMask;
+
+        if (!(blocks & tMask).isEmpty()) {
+            break;
+        }
+    }
+    return mask;
+}
+
+Bitboard generateSingleBishopAttacks(Square square, Bitboard blocks) {
+    Bitboard attacks;
+    attacks |= bishopNorthEastAttacks(square, blocks);
+    attacks |= bishopSouthEastAttacks(square, blocks);
+    attacks |= bishopNorthWestAttacks(square, blocks);
+    attacks |= bishopSouthWestAttacks(square, blocks);
+
+    return attacks;
+}
+
+#pragma endregion
+
+#pragma region Rooks
+
+Bitboard northRelevantOccupancies(Square square) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank + 1; rank < 7; rank++) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + pieceFile);
+        mask |= tMask;
+    }
+    return mask;
+}
+
+Bitboard southRelevantOccupancies(Square square) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank - 1; rank > 0; rank--) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + pieceFile);
+        mask |= tMask;
+    }
+    return mask;
+}
+
+Bitboard westRelevantOccupancies(Square square) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int file = pieceFile - 1; file > 0; file--) {
+        Bitboard tMask = Bitboard::fromSquare(pieceRank * 8 + file);
+        mask |= tMask;
+    }
+    return mask;
+}
+
+Bitboard eastRelevantOccupancies(Square square) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int file = pieceFile + 1; file < 7; file++) {
+        Bitboard tMask = Bitboard::fromSquare(pieceRank * 8 + file);
+        mask |= tMask;
+    }
+    return mask;
+}
+
+Bitboard generateSingleRookRelevantOccupanciesMask(Square square) {
+    Bitboard mask;
+    mask |= northRelevantOccupancies(square);
+    mask |= southRelevantOccupancies(square);
+    mask |= westRelevantOccupancies(square);
+    mask |= eastRelevantOccupancies(square);
+
+    return mask;
+}
+
+Bitboard rookNorthAttacks(Square square, Bitboard blocks) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank + 1; rank < 8; rank++) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + pieceFile);
+        mask |= tMask;
+
+        if (!(blocks & tMask).isEmpty()) {
+            break;
+        }
+    }
+    return mask;
+}
+
+Bitboard rookSouthAttacks(Square square, Bitboard blocks) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int rank = pieceRank - 1; rank >= 0; rank--) {
+        Bitboard tMask = Bitboard::fromSquare(rank * 8 + pieceFile);
+        mask |= tMask;
+
+        if (!(blocks & tMask).isEmpty()) {
+            break;
+        }
+    }
+    return mask;
+}
+
+Bitboard rookWestAttacks(Square square, Bitboard blocks) {
+    Bitboard mask;
+
+    int pieceRank = square / 8;
+    int pieceFile = square % 8;
+
+    for (int file = pieceFile - 1; file >= 0; file--) {
+        Bitboard tMask = Bitboard::fromSquare(pieceRank * 8 + file);
+        mask |= tMask;
+
+        if (!(blocks & tMask).isEmpty()) {
+            break;
+        }
+    }
+    return mask;
+}
+
+Bitboard rookEastAttacks(Square square, Bitboard blocks) {
+    Bitboard mask;
+
+    int pieceFile = square % 8;
+    int pieceRank = square / 8;
+
+    for (int file = pieceFile + 1; file < 8; file++) {
+        Bitboard tMask = Bitboard::fromSquare(pieceRank * 8 + file);
+        mask |= tMask;
+
+        if (!(blocks & tMask).isEmpty()) {
+            break;
+        }
+    }
+    return mask;
+}
+
+Bitboard generateSingleRookAttacks(Square square, Bitboard blocks) {
+    Bitboard attacks;
+    attacks |= rookNorthAttacks(square, blocks);
+    attacks |= rookSouthAttacks(square, blocks);
+    attacks |= rookWestAttacks(square, blocks);
+    attacks |= rookEastAttacks(square, blocks);
+
+    return attacks;
+}
+
+#pragma endregion
+
+#pragma region Sliding Pieces Logic
+
+Bitboard setOccupancy(int index, Bitboard attacksMask) {
+    Bitboard occupancyMask;
+    int attacksMaskPopCount = attacksMask.popCount();
+
+    for (int count = 0; count < attacksMaskPopCount; count++) {
+        int square = attacksMask.leastSignificantBeatIndex();
+        attacksMask.clearBit(square);
+
+        if (index & (1 << count)) {
+            occupancyMask |= Bitboard::fromSquare(square);
+        }
+    }
+
+    return occupancyMask;
+}
+
+void generateSliderPiecesAttacks(AttackTables& tables, SlidingPiece piece) {
+    bool bishop = piece == IS_BISHOP;
+    SliderMagic* magics = bishop ? tables.bishopMagics : tables.rookMagics;
+
+    // Rook slices first, bishop ones right after them
+    uint32_t offset = bishop ? ROOK_ATTACKS_ENTRIES : 0;
+
+    for (int index = 0; index < 64; index++) {
+        Square square = static_cast<Square>(index);
+        SliderMagic& entry = magics[square];
+
+        entry.mask =
+            bishop ? generateSingleBishopRelevantOccupanciesMask(square)
+                   : generateSingleRookRelevantOccupanciesMask(square);
+        entry.magic =
+            bishop ? bishopMagicNumbers[square] : rookMagicNumbers[square];
+        entry.shift = 64 - entry.mask.popCount();
+        entry.offset = offset;
+
+        int occupancyIndices = 1 << entry.mask.popCount();
+
+        for (int occupancyIndex = 0; occupancyIndex < occupancyIndices;
+             occupancyIndex++) {
+            Bitboard occupancy = setOccupancy(occupancyIndex, entry.mask);
+            tables.sliderAttacks[sliderIndex(tables, entry, occupancy)] =
+                bishop ? generateSingleBishopAttacks(square, occupancy)
+                       : generateSingleRookAttacks(square, occupancy);
+        }
+        offset += occupancyIndices;
+    }
+
+    assert(offset == (bishop ? SLIDER_ATTACKS_ENTRIES : ROOK_ATTACKS_ENTRIES));
+}
+
+#pragma endregion
+
+#pragma region Between squares
+
+void generateBetweenMasks(AttackTables& tables) {
+    for (int from = a1; from <= h8; from++) {
+        for (int to = a1; to <= h8; to++) {
+            Square a = static_cast<Square>(from);
+            Square b = static_cast<Square>(to);
+            Bitboard between;
+
+            // Both rays stop on the other square, they overlap in between
+            if (generateSingleRookAttacks(a, Bitboard()).getBit(b)) {
+                between =
+                    generateSingleRookAttacks(a, Bitboard::fromSquare(b)) &
+                    generateSingleRookAttacks(b, Bitboard::fromSquare(a));
+            } else if (generateSingleBishopAttacks(a, Bitboard()).getBit(b)) {
+                between =
+                    generateSingleBishopAttacks(a, Bitboard::fromSquare(b)) &
+                    generateSingleBishopAttacks(b, Bitboard::fromSquare(a));
+            }
+            tables.betweenMasks[from][to] = between;
+        }
+    }
+}
+
+#pragma endregion
+
+bool isPextSupported() {
+#ifdef KHEZ_PEXT
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+SliderBackend defaultSliderBackend() {
+    return isPextSupported() ? PEXT_BACKEND : MAGIC_BACKEND;
+}
+
+// Built on the heap, the tables are too large for a thread stack
+std::unique_ptr<AttackTables> buildAttackTables(SliderBackend backend) {
+    assert(backend == MAGIC_BACKEND || isPextSupported());
+
+    auto tables = std::make_unique<AttackTables>();
+    tables->sliderBackend = backend;
+    generatePawnMaskAttacks(*tables);
+    generateKnightMaskMoves(*tables);
+    generateKingMaskMoves(*tables);
+    generateSliderPiecesAttacks(*tables, IS_BISHOP);
+    generateSliderPiecesAttacks(*tables, IS_ROOK);
+    generateBetweenMasks(*tables);
+    return tables;
+}
+
+const AttackTables& attackTables() {
+    // Function local statics are initialised once, other threads wait for
+    // the first caller to finish. Never freed, like any process-wide table.
+    static const AttackTables* tables =
+        buildAttackTables(defaultSliderBackend()).release();
+    return *tables;
+}
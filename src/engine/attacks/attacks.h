@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#ifdef KHEZ_PEXT
+#include <immintrin.h>
+#endif
+
+#include "../../bitboard/bitboard.h"
+#include "../chessboard/color.h"
+#include "../chessboard/square.h"
+#include "../masks/masks.h"
+
+// One entry per relevant occupancy subset, summed over the squares
+constexpr uint32_t ROOK_ATTACKS_ENTRIES = 102400;
+constexpr uint32_t BISHOP_ATTACKS_ENTRIES = 5248;
+constexpr uint32_t SLIDER_ATTACKS_ENTRIES =
+    ROOK_ATTACKS_ENTRIES + BISHOP_ATTACKS_ENTRIES;
+
+// How the relevant occupancies of a slider become an index in its slice
+enum SliderBackend {
+    MAGIC_BACKEND,  // Multiply by the magic number and shift
+    PEXT_BACKEND,   // BMI2 PEXT gathers the relevant bits, no magic needed
+};
+
+/*
+  Fancy magic of a slider on one square: its attacks are the slice of
+  sliderAttacks starting at offset, sized by its own relevant bits rather
+  than by the worst square. Padded so a record never spans two cache lines.
+  The PEXT backend uses the same slices, ordered by the PEXT index, and
+  ignores magic and shift.
+*/
+struct alignas(32) SliderMagic {
+    Bitboard mask;
+    uint64_t magic;
+    uint32_t offset;
+    uint32_t shift;
+
+    uint32_t index(Bitboard occupancies) const {
+        return offset + (((occupancies & mask).getValue() * magic) >> shift);
+    }
+};
+
+/*
+  Leaper masks, magic slider tables and the squares between two aligned
+  squares. They never change, so one copy is shared by every engine and
+  search thread of the process, built on the first call to attackTables().
+*/
+struct AttackTables {
+    SliderBackend sliderBackend;
+
+    Bitboard pawnAttacksMasks[2][64];
+
+    Bitboard knightAttacksMasks[64];
+
+    Bitboard kingAttacksMasks[64];
+
+    SliderMagic bishopMagics[64];
+    SliderMagic rookMagics[64];
+
+    // Every slider attack set, packed one square slice after the other
+    Bitboard sliderAttacks[SLIDER_ATTACKS_ENTRIES];
+
+    // Squares strictly between two aligned squares, empty otherwise
+    Bitboard betweenMasks[64][64];
+};
+
+// PEXT when built with KHEZ_PEXT and the CPU has BMI2, magics otherwise
+bool isPextSupported();
+SliderBackend defaultSliderBackend();
+
+std::unique_ptr<AttackTables> buildAttackTables(SliderBackend backend);
+
+// Thread-safe, concurrent first callers wait for a single build
+const AttackTables& attackTables();
+
+#ifdef KHEZ_PEXT
+// Compiled for BMI2 whatever the target, only called once the CPU is checked
+__attribute__((target("bmi2"))) inline uint64_t parallelBitsExtract(
+    uint64_t value, uint64_t mask) {
+    return _pext_u64(value, mask);
+}
+#endif
+
+inline uint32_t sliderIndex(const AttackTables& tables,
+                            const SliderMagic& slider, Bitboard occupancies) {
+#ifdef KHEZ_PEXT
+    if (tables.sliderBackend == PEXT_BACKEND) {
+        return slider.offset + parallelBitsExtract(occupancies.getValue(),
+                                                   slider.mask.getValue());
+    }
+#endif
+    return slider.index(occupancies);
+}
+
+inline Bitboard bishopAttacks(const AttackTables& tables, Square square,
+                              Bitboard occupancies) {
+    return tables.sliderAttacks[sliderIndex(
+        tables, tables.bishopMagics[square], occupancies)];
+}
+
+inline Bitboard rookAttacks(const AttackTables& tables, Square square,
+                            Bitboard occupancies) {
+    return tables.sliderAttacks[sliderIndex(tables, tables.rookMagics[square],
+                                            occupancies)];
+}
+
+// Table generation, slow loops over the board kept for tests and for the
+// magic number search
+
+Bitboard generateSinglePawnMaskAttacks(Square square, Color color);
+Bitboard generateSingleKnightAttacksMask(Square square);
+Bitboard generateSingleKingAttacksMask(Square square);
+
+Bitboard generateSingleBishopRelevantOccupanciesMask(Square square);
+Bitboard generateSingleBishopAttacks(Square square, Bitboard blocks);
+
+Bitboard generateSingleRookRelevantOccupanciesMask(Square square);
+Bitboard generateSingleRookAttacks(Square square, Bitboard blocks);
+
+// Spreads the bits of index over the squares of attacksMask
+Bitboard setOccupancy(int index, Bitboard attacksMask);
+
+// Squares attacked by a whole set of pawns
+
+inline Bitboard whitePawnWestAttack(Bitboard pawn) {
+    return (pawn & notAFile) >> 7;
+}
+inline Bitboard whitePawnEastAttack(Bitboard pawn) {
+    return (pawn & notHFile) >> 9;
+}
+
+inline Bitboard blackPawnWestAttack(Bitboard pawn) {
+    return (pawn & notAFile) << 9;
+}
+inline Bitboard blackPawnEastAttack(Bitboard pawn) {
+    return (pawn & notHFile) << 7;
+}
@@ -1,13 +1,14 @@
 #pragma once
 
 #include <optional>
+#include <utility>
 
 #include "../../bitboard/bitboard.h"
 #include "./color.h"
 #include "./piece.h"
 #include "./square.h"
 
-enum PieceBoard {
+enum PieceBoard : uint8_t {
     WHITE_PAWNS,
     BLACK_PAWNS,
     WHITE_ROOKS,
@@ -28,11 +29,26 @@ enum PieceBoard {
     BOARDS_COUNTER,  // Must be last - used only for size
 };
 
-extern const std::map<std::pair<Color, Piece>, PieceBoard>
-    sideColorToPieceBoardMap;
+// Marks "no piece" wherever a PieceBoard is expected (e.g. nothing captured)
+const PieceBoard NO_PIECE = BOARDS_COUNTER;
 
-extern const std::map<PieceBoard, std::pair<Color, Piece>>
-    pieceBoardToSideColorMap;
+// Piece boards alternate white and black in Piece order
+constexpr PieceBoard sideColorToPieceBoard[2][6] = {
+    {WHITE_PAWNS, WHITE_ROOKS, WHITE_KNIGHTS, WHITE_BISHOPS, WHITE_QUEEN,
+     WHITE_KING},
+    {BLACK_PAWNS, BLACK_ROOKS, BLACK_KNIGHTS, BLACK_BISHOPS, BLACK_QUEEN,
+     BLACK_KING},
+};
+
+constexpr std::pair<Color, Piece> pieceBoardToSideColor[12] = {
+    {WHITE, PAWN},   {BLACK, PAWN},   {WHITE, ROOK},   {BLACK, ROOK},
+    {WHITE, KNIGHT}, {BLACK, KNIGHT}, {WHITE, BISHOP}, {BLACK, BISHOP},
+    {WHITE, QUEEN},  {BLACK, QUEEN},  {WHITE, KING},   {BLACK, KING},
+};
+
+constexpr PieceBoard pieceBoardOf(Piece piece, Color color) {
+    return sideColorToPieceBoard[color][piece];
+}
 
 enum Castle {
     WHITE_KINGSIDE = 0b0001,
@@ -41,8 +57,21 @@ enum Castle {
     BLACK_QUEENSIDE = 0b1000,
 };
 
+// Sums of pieceSquareScores over the pieces on the board
+struct EvaluationScores {
+    int middleGame;
+    int endGame;
+    int phase;
+
+    bool operator==(const EvaluationScores& other) const {
+        return middleGame == other.middleGame && endGame == other.endGame &&
+               phase == other.phase;
+    }
+};
+
 struct ChessboardStatus {
     Bitboard boards[BOARDS_COUNTER];
+    PieceBoard mailbox[64];  // Piece on each square, NO_PIECE when empty
 
     std::optional<Color> side;
     std::optional<Square> enpassant;
@@ -50,4 +79,15 @@ struct ChessboardStatus {
 
     int halfmoveCounter;
     int fullmoveNumber;
+
+    uint64_t hashKey;  // Zobrist key, updated incrementally by make/undo
+    EvaluationScores scores;  // Updated incrementally like the hash key
+};
+
+// Minimal information needed to take back a move without a full status copy
+struct UndoRecord {
+    PieceBoard captured;
+    int8_t availableCastle;
+    std::optional<Square> enpassant;
+    int halfmoveCounter;
 };
@@ -8,6 +8,8 @@
 #include <sstream>
 #include <vector>
 
+#include "../zobrist/zobrist.h"
+
 ChessBoard::ChessBoard() { emptyBoard(); }
 
 void ChessBoard::emptyBoard() {
@@ -25,6 +27,7 @@ void ChessBoard::emptyBoard() {
     status.boards[BLACK_KING] = Bitboard();
 
     updateAllOccupancyBoards();
+    updateMailbox();
 
     status.side.reset();
     status.availableCastle = 0b1111;
@@ -33,6 +36,18 @@ void ChessBoard::emptyBoard() {
     status.fullmoveNumber = 1;
     moveHistory.clear();
     statusHistory.clear();
+    undoHistory.clear();
+
+    // Reserved up front so making moves does not allocate in practice
+    moveHistory.reserve(HISTORY_RESERVE);
+    if (undoMode == UNDO_SNAPSHOT) {
+        statusHistory.reserve(HISTORY_RESERVE);
+    } else {
+        undoHistory.reserve(HISTORY_RESERVE);
+    }
+
+    status.hashKey = computeHashKey();
+    status.scores = computeScores();
 }
 
 void ChessBoard::setupInitialPosition() {
@@ -52,8 +67,11 @@ void ChessBoard::setupInitialPosition() {
     status.boards[BLACK_KING] = blackKing;
 
     updateAllOccupancyBoards();
+    updateMailbox();
 
     status.side = WHITE;
+    status.hashKey = computeHashKey();
+    status.scores = computeScores();
 }
 
 std::vector<std::string> split(std::string s, const char* delim) {
@@ -103,151 +121,364 @@ void ChessBoard::parseFEN(const std::string FEN) {
         (result.size() > 5 && !result[5].empty()) ? std::stoi(result[5]) : 1;
 
     updateAllOccupancyBoards();
+    status.hashKey = computeHashKey();
+    status.scores = computeScores();
+}
+
+Square capturedSquare(const Square to, const bool isEnpassant,
+                      const Color side) {
+    if (isEnpassant) {
+        return static_cast<Square>(to + (side == WHITE ? -8 : +8));
+    }
+    return to;
+}
+
+std::pair<Square, Square> castlingRookSquares(const Square kingTo) {
+    switch (kingTo) {
+        case g1:
+            return {h1, f1};
+        case c1:
+            return {a1, d1};
+        case g8:
+            return {h8, f8};
+        default:  // c8
+            return {a8, d8};
+    }
 }
 
 void ChessBoard::makePsuedoLegalMove(Move move) {
-    moveHistory.push_back(move);
-    statusHistory.push_back(status);
+    makePsuedoLegalMove(move.toBinary());
+}
 
-    clearPieceAt(move.from);
+// Fields are read straight from the packed move, nothing is decoded into a
+// Move on the search and perft paths
+void ChessBoard::makePsuedoLegalMove(u_int32_t move) {
+    Square from = static_cast<Square>(move & 0x3f);
+    Square to = static_cast<Square>((move >> 6) & 0x3f);
+    Piece piece = static_cast<Piece>((move >> 12) & 0xf);
+    Piece promoted = static_cast<Piece>((move >> 16) & 0xf);
+    bool isCapture = (move >> 20) & 1;
+    bool isDoublePush = (move >> 21) & 1;
+    bool isEnpassant = (move >> 22) & 1;
+    bool isCastling = (move >> 23) & 1;
+
+    Color side = status.side.value();
+    PieceBoard moved = pieceOn(from);
+    Square captureSquare = capturedSquare(to, isEnpassant, side);
+    PieceBoard captured = isCapture ? pieceOn(captureSquare) : NO_PIECE;
 
-    if (move.isCapture) {
-        makeMoveCapture(move);
+    moveHistory.push_back(move);
+
+    if (undoMode == UNDO_SNAPSHOT) {
+        statusHistory.push_back(status);
     } else {
-        makeMoveQuite(move);
+        undoHistory.push_back(UndoRecord{captured, status.availableCastle,
+                                         status.enpassant,
+                                         status.halfmoveCounter});
+    }
+
+    if (captured != NO_PIECE) {
+        removePiece(captured, captureSquare);
     }
 
     // Promotion
-    if (move.promoted != EMPTY) {
-        clearPieceAt(move.to);
-        setPieceAt(move.to, move.promoted, status.side.value());
+    if (promoted != EMPTY) {
+        removePiece(moved, from);
+        addPiece(pieceBoardOf(promoted, side), to);
+    } else {
+        movePiece(moved, from, to);
     }
 
-    // reset enpassant
-    if (move.type != PAWN_DOUBLE_PUSH) {
-        status.enpassant.reset();
+    if (isCastling) {
+        auto [rookFrom, rookTo] = castlingRookSquares(to);
+        movePiece(side == WHITE ? WHITE_ROOKS : BLACK_ROOKS, rookFrom, rookTo);
+    }
+
+    // enpassant
+    status.hashKey ^= zobristEnpassantKey(status.enpassant);
+    status.enpassant.reset();
+    if (isDoublePush) {
+        int file = side == WHITE ? -8 : +8;
+        status.enpassant = static_cast<Square>(to + file);
+        status.hashKey ^= zobristEnpassantKey(status.enpassant);
     }
 
     if (status.availableCastle) {
-        makeMoveCastlingChecks(move);
+        status.hashKey ^= zobristKeys.castling[status.availableCastle];
+        makeMoveCastlingChecks(from, to);
+        status.hashKey ^= zobristKeys.castling[status.availableCastle];
     }
 
     // halfmove counter
-    if (move.piece == PAWN || move.isCapture) {
+    if (piece == PAWN || isCapture) {
         status.halfmoveCounter = 0;
     } else {
         status.halfmoveCounter++;
     }
 
     // Full move counter
-    if (status.side == BLACK) {
+    if (side == BLACK) {
         status.fullmoveNumber++;
     }
 
     // side
-    status.side = ((status.side.value() == WHITE) ? BLACK : WHITE);
+    status.side = ((side == WHITE) ? BLACK : WHITE);
+    status.hashKey ^= zobristKeys.side;
+
+    assert(isOccupancyConsistent());
+    assert(isMailboxConsistent());
+    assert(isScoresConsistent());
+}
+
+void ChessBoard::makeMoveCastlingChecks(const Square from, const Square to) {
+    status.availableCastle &= castlingRights[from];
+    status.availableCastle &= castlingRights[to];
+}
+
+void ChessBoard::undoLastMove() {
+    if (undoMode == UNDO_SNAPSHOT) {
+        undoLastMoveSnapshot();
+    } else {
+        undoLastMoveIncremental();
+    }
 }
 
-void ChessBoard::makeMoveCastlingChecks(Move& move) {
-    status.availableCastle &= castlingRights[move.from];
-    status.availableCastle &= castlingRights[move.to];
+void ChessBoard::undoLastMoveSnapshot() {
+    ChessboardStatus previuousStatus = statusHistory.back();
+    status = previuousStatus;
+
+    statusHistory.pop_back();
+    moveHistory.pop_back();
 }
 
-void ChessBoard::makeMoveQuite(Move& move) {
-    setPieceAt(move.to, move.piece, status.side.value());
+void ChessBoard::undoLastMoveIncremental() {
+    u_int32_t move = moveHistory.back();
+    const UndoRecord& undo = undoHistory.back();
+
+    Square from = static_cast<Square>(move & 0x3f);
+    Square to = static_cast<Square>((move >> 6) & 0x3f);
+    Piece piece = static_cast<Piece>((move >> 12) & 0xf);
+    Piece promoted = static_cast<Piece>((move >> 16) & 0xf);
+    bool isEnpassant = (move >> 22) & 1;
+    bool isCastling = (move >> 23) & 1;
+
+    Color side = (status.side.value() == WHITE) ? BLACK : WHITE;
+    PieceBoard moved = (promoted != EMPTY)
+                           ? pieceBoardOf(piece, side)
+                           : pieceOn(to);
+
+    if (isCastling) {
+        auto [rookFrom, rookTo] = castlingRookSquares(to);
+        movePiece(side == WHITE ? WHITE_ROOKS : BLACK_ROOKS, rookTo, rookFrom);
+    }
 
-    if (move.promoted != EMPTY) {
-        clearPieceAt(move.to);
-        setPieceAt(move.to, move.promoted, status.side.value());
+    if (promoted != EMPTY) {
+        removePiece(pieceBoardOf(promoted, side), to);
+        addPiece(moved, from);
+    } else {
+        movePiece(moved, to, from);
     }
 
-    if (move.isCastling) {
-        if (status.side == WHITE) {
-            if (move.to == g1) {  // White kingside
-                clearPieceAt(h1);
-                setPieceAt(f1, 'R');
-            }
+    if (undo.captured != NO_PIECE) {
+        addPiece(undo.captured, capturedSquare(to, isEnpassant, side));
+    }
 
-            if (move.to == c1) {  // White queenside
-                clearPieceAt(a1);
-                setPieceAt(d1, 'R');
-            }
-        } else {
-            if (move.to == g8) {  // Black kingside
-                clearPieceAt(h8);
-                setPieceAt(f8, 'r');
-            }
+    status.hashKey ^= zobristKeys.side;
+    status.hashKey ^= zobristEnpassantKey(status.enpassant) ^
+                      zobristEnpassantKey(undo.enpassant);
+    status.hashKey ^= zobristKeys.castling[status.availableCastle] ^
+                      zobristKeys.castling[undo.availableCastle];
+
+    status.side = side;
+    status.enpassant = undo.enpassant;
+    status.availableCastle = undo.availableCastle;
+    status.halfmoveCounter = undo.halfmoveCounter;
+    if (side == BLACK) {
+        status.fullmoveNumber--;
+    }
 
-            if (move.to == c8) {  // Black queenside
-                clearPieceAt(a8);
-                setPieceAt(d8, 'r');
-            }
+    undoHistory.pop_back();
+    moveHistory.pop_back();
+
+    assert(isOccupancyConsistent());
+    assert(isMailboxConsistent());
+    assert(isScoresConsistent());
+}
+
+std::optional<Square> ChessBoard::makeNullMove() {
+    std::optional<Square> enpassant = status.enpassant;
+
+    status.hashKey ^= zobristKeys.side ^ zobristEnpassantKey(enpassant);
+    status.enpassant.reset();
+    status.side = status.side.value() == WHITE ? BLACK : WHITE;
+
+    return enpassant;
+}
+
+void ChessBoard::undoNullMove(std::optional<Square> enpassant) {
+    status.hashKey ^= zobristKeys.side ^ zobristEnpassantKey(enpassant);
+    status.enpassant = enpassant;
+    status.side = status.side.value() == WHITE ? BLACK : WHITE;
+}
+
+// Piece boards alternate white/black, so the parity gives the occupancy board
+inline PieceBoard occupancyBoardOf(const PieceBoard pieceBoard) {
+    return static_cast<PieceBoard>(WHITE_ALL + (pieceBoard & 1));
+}
+
+inline void ChessBoard::addPiece(const PieceBoard pieceBoard,
+                                 const Square square) {
+    Bitboard mask = Bitboard::fromSquare(square);
+    status.boards[pieceBoard] ^= mask;
+    status.boards[occupancyBoardOf(pieceBoard)] ^= mask;
+    status.boards[ALL_PIECES] ^= mask;
+    status.mailbox[square] = pieceBoard;
+    status.hashKey ^= zobristKeys.pieces[pieceBoard][square];
+    status.scores.middleGame +=
+        pieceSquareScores.middleGame[pieceBoard][square];
+    status.scores.endGame += pieceSquareScores.endGame[pieceBoard][square];
+    status.scores.phase += pieceSquareScores.phase[pieceBoard];
+}
+
+inline void ChessBoard::removePiece(const PieceBoard pieceBoard,
+                                    const Square square) {
+    Bitboard mask = Bitboard::fromSquare(square);
+    status.boards[pieceBoard] ^= mask;
+    status.boards[occupancyBoardOf(pieceBoard)] ^= mask;
+    status.boards[ALL_PIECES] ^= mask;
+    status.mailbox[square] = NO_PIECE;
+    status.hashKey ^= zobristKeys.pieces[pieceBoard][square];
+    status.scores.middleGame -=
+        pieceSquareScores.middleGame[pieceBoard][square];
+    status.scores.endGame -= pieceSquareScores.endGame[pieceBoard][square];
+    status.scores.phase -= pieceSquareScores.phase[pieceBoard];
+}
+
+inline void ChessBoard::movePiece(const PieceBoard pieceBoard,
+                                  const Square from, const Square to) {
+    Bitboard mask = Bitboard::fromSquare(from) ^ Bitboard::fromSquare(to);
+    status.boards[pieceBoard] ^= mask;
+    status.boards[occupancyBoardOf(pieceBoard)] ^= mask;
+    status.boards[ALL_PIECES] ^= mask;
+    status.mailbox[from] = NO_PIECE;
+    status.mailbox[to] = pieceBoard;
+    status.hashKey ^= zobristKeys.pieces[pieceBoard][from] ^
+                      zobristKeys.pieces[pieceBoard][to];
+    status.scores.middleGame += pieceSquareScores.middleGame[pieceBoard][to] -
+                                pieceSquareScores.middleGame[pieceBoard][from];
+    status.scores.endGame += pieceSquareScores.endGame[pieceBoard][to] -
+                             pieceSquareScores.endGame[pieceBoard][from];
+}
+
+uint64_t ChessBoard::computeHashKey() const {
+    uint64_t key = 0ULL;
+
+    for (int boardsIndex = 0; boardsIndex < 12; boardsIndex++) {
+        Bitboard bitboard = status.boards[boardsIndex];
+        while (!bitboard.isEmpty()) {
+            int square = bitboard.leastSignificantBeatIndex();
+            key ^= zobristKeys.pieces[boardsIndex][square];
+            bitboard.clearBit(square);
         }
     }
 
-    if (move.isDoublePush) {
-        int file = status.side.value() == WHITE ? -8 : +8;
-        status.enpassant = static_cast<Square>(move.to + file);
+    key ^= zobristKeys.castling[status.availableCastle];
+    key ^= zobristEnpassantKey(status.enpassant);
+    if (status.side == BLACK) {
+        key ^= zobristKeys.side;
     }
+
+    return key;
 }
 
-void ChessBoard::makeMoveCapture(Move& move) {
-    if (move.isEnpassant) {
-        int file = status.side.value() == WHITE ? -8 : +8;
-        clearPieceAt(static_cast<Square>(status.enpassant.value() + file));
-        setPieceAt(move.to, move.piece, status.side.value());
-    } else {
-        clearPieceAt(move.to);
-        setPieceAt(move.to, move.piece, status.side.value());
+EvaluationScores ChessBoard::computeScores() const {
+    EvaluationScores scores{};
+
+    for (int boardsIndex = 0; boardsIndex < 12; boardsIndex++) {
+        Bitboard bitboard = status.boards[boardsIndex];
+        while (!bitboard.isEmpty()) {
+            int square = bitboard.leastSignificantBeatIndex();
+            scores.middleGame +=
+                pieceSquareScores.middleGame[boardsIndex][square];
+            scores.endGame += pieceSquareScores.endGame[boardsIndex][square];
+            scores.phase += pieceSquareScores.phase[boardsIndex];
+            bitboard.clearBit(square);
+        }
     }
+
+    return scores;
 }
 
-void ChessBoard::undoLastMove() {
-    ChessboardStatus previuousStatus = statusHistory.back();
-    status = previuousStatus;
+bool ChessBoard::isOccupancyConsistent() const {
+    Bitboard whites;
+    Bitboard blacks;
+    for (int boardsIndex = 0; boardsIndex < 12; boardsIndex++) {
+        if (occupancyBoardOf(static_cast<PieceBoard>(boardsIndex)) ==
+            WHITE_ALL) {
+            whites |= status.boards[boardsIndex];
+        } else {
+            blacks |= status.boards[boardsIndex];
+        }
+    }
 
-    statusHistory.pop_back();
-    moveHistory.pop_back();
+    return whites == status.boards[WHITE_ALL] &&
+           blacks == status.boards[BLACK_ALL] &&
+           (whites | blacks) == status.boards[ALL_PIECES];
+}
+
+bool ChessBoard::isMailboxConsistent() const {
+    for (int square = 0; square < 64; square++) {
+        PieceBoard pieceBoard = status.mailbox[square];
+        if (pieceBoard == NO_PIECE) {
+            if (status.boards[ALL_PIECES].getBit(square)) {
+                return false;
+            }
+        } else if (!status.boards[pieceBoard].getBit(square)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ChessBoard::isScoresConsistent() const {
+    return status.scores == computeScores();
+}
+
+void ChessBoard::updateMailbox() {
+    for (int square = 0; square < 64; square++) {
+        status.mailbox[square] = NO_PIECE;
+        for (int boardsIndex = 0; boardsIndex < 12; boardsIndex++) {
+            if (status.boards[boardsIndex].getBit(square)) {
+                status.mailbox[square] = static_cast<PieceBoard>(boardsIndex);
+                break;
+            }
+        }
+    }
 }
 
 void ChessBoard::setPieceAt(const Square square, const Piece piece,
                             const Color color) {
     assert(square >= 0 && square < 64);
 
-    status.boards[sideColorToPieceBoardMap.at({color, piece})].setBit(square);
-    updateAllOccupancyBoards();
+    clearPieceAt(square);
+    addPiece(pieceBoardOf(piece, color), square);
 }
 
 void ChessBoard::setPieceAt(const Square square, const char p) {
     assert(strchr(pieceNames_, p));
 
-    std::map<char, std::pair<Color, Piece>> indexMap = {{
-        {'P', {WHITE, PAWN}},
-        {'B', {WHITE, BISHOP}},
-        {'N', {WHITE, KNIGHT}},
-        {'R', {WHITE, ROOK}},
-        {'K', {WHITE, KING}},
-        {'Q', {WHITE, QUEEN}},
-        {'p', {BLACK, PAWN}},
-        {'b', {BLACK, BISHOP}},
-        {'n', {BLACK, KNIGHT}},
-        {'r', {BLACK, ROOK}},
-        {'k', {BLACK, KING}},
-        {'q', {BLACK, QUEEN}},
-    }};
-    Color color = indexMap.at(p).first;
-    Piece piece = indexMap.at(p).second;
+    // Piece names are listed in PieceBoard order
+    PieceBoard pieceBoard = static_cast<PieceBoard>(strchr(pieceNames_, p) -
+                                                    pieceNames_);
+    auto [color, piece] = pieceBoardToSideColor[pieceBoard];
     setPieceAt(square, piece, color);
 }
 
 void ChessBoard::clearPieceAt(const Square square) {
-    for (int boardsIndex = 0; boardsIndex < 12; boardsIndex++) {
-        if (status.boards[boardsIndex].getBit(square)) {
-            status.boards[boardsIndex].clearBit(square);
-            break;
-        }
+    PieceBoard pieceBoard = pieceOn(square);
+    if (pieceBoard != NO_PIECE) {
+        removePiece(pieceBoard, square);
     }
-    updateAllOccupancyBoards();
 }
 
 std::string ChessBoard::toString() const {
@@ -269,12 +500,8 @@ std::string ChessBoard::toString() const {
 }
 
 char ChessBoard::getPieceAt(const Square square) const {
-    for (int boardsIndex = 0; boardsIndex < 12; boardsIndex++) {
-        if (status.boards[boardsIndex].getBit(square)) {
-            return pieceNames_[boardsIndex];
-        }
-    }
-    return '.';
+    PieceBoard pieceBoard = pieceOn(square);
+    return pieceBoard != NO_PIECE ? pieceNames_[pieceBoard] : '.';
 }
 
 std::string ChessBoard::toStringFancy() const {
@@ -296,12 +523,8 @@ std::string ChessBoard::toStringFancy() const {
 }
 
 std::string ChessBoard::getPieceAtFancy(const Square square) const {
-    for (int boardsIndex = 0; boardsIndex < 12; boardsIndex++) {
-        if (status.boards[boardsIndex].getBit(square)) {
-            return pieceSymbols_[boardsIndex];
-        }
-    }
-    return ".";
+    PieceBoard pieceBoard = pieceOn(square);
+    return pieceBoard != NO_PIECE ? pieceSymbols_[pieceBoard] : ".";
 }
 
 std::string ChessBoard::availableCastleToString() const {
@@ -12,26 +12,53 @@
 #include "./piece.h"
 #include "./square.h"
 
+const size_t HISTORY_RESERVE = 1024;
+
+enum UndoMode {
+    UNDO_INCREMENTAL,  // Store an UndoRecord and reverse the move on the boards
+    UNDO_SNAPSHOT,     // Store a full ChessboardStatus copy for every move
+};
+
 class ChessBoard {
    public:
     ChessBoard();
 
     ChessboardStatus status;
 
-    std::vector<Move> moveHistory;
+    // Only change it while no move is pending, make and undo must agree
+    UndoMode undoMode = UNDO_INCREMENTAL;
+
+    std::vector<u_int32_t> moveHistory;  // Packed as Move::toBinary
     std::vector<ChessboardStatus> statusHistory;
+    std::vector<UndoRecord> undoHistory;
 
     void emptyBoard();
     void setupInitialPosition();
     void parseFEN(const std::string FEN);
 
     void makePsuedoLegalMove(Move move);
+    void makePsuedoLegalMove(u_int32_t move);
     void undoLastMove();
 
+    // Passes the turn for null move pruning, outside the move history. The
+    // returned en passant square must be handed back to undoNullMove.
+    std::optional<Square> makeNullMove();
+    void undoNullMove(std::optional<Square> enpassant);
+
     void setPieceAt(const Square square, const Piece piece, const Color color);
     void setPieceAt(const Square square, const char piece);
     void clearPieceAt(const Square square);
     char getPieceAt(const Square square) const;
+    PieceBoard pieceOn(const Square square) const {
+        return status.mailbox[square];
+    }
+
+    uint64_t computeHashKey() const;
+    EvaluationScores computeScores() const;
+
+    bool isOccupancyConsistent() const;
+    bool isMailboxConsistent() const;
+    bool isScoresConsistent() const;
 
     std::string toString() const;
     std::string getPieceAtFancy(const Square square) const;
@@ -40,16 +67,25 @@ class ChessBoard {
     std::string toStringComplete() const;
 
    private:
-    char pieceNames_[12] = {'P', 'p', 'R', 'r', 'N', 'n',
-                            'B', 'b', 'Q', 'q', 'K', 'k'};
+    // Null terminated in PieceBoard order, parseFEN looks pieces up with strchr
+    char pieceNames_[13] = "PpRrNnBbQqKk";
 
     std::string pieceSymbols_[12] = {"♙", "♟︎", "♖", "♜", "♘", "♞",
                                      "♗", "♝", "♕", "♛", "♔", "♚"};
 
     void updateAllOccupancyBoards();
     void parseFENCastling(const std::string FEN_castling);
+    void updateMailbox();
+
+    // O(1) edits keeping WHITE_ALL, BLACK_ALL, ALL_PIECES and the mailbox
+    // in sync
+    void addPiece(const PieceBoard pieceBoard, const Square square);
+    void removePiece(const PieceBoard pieceBoard, const Square square);
+    void movePiece(const PieceBoard pieceBoard, const Square from,
+                   const Square to);
+
+    void makeMoveCastlingChecks(const Square from, const Square to);
 
-    void makeMoveCapture(Move& move);
-    void makeMoveQuite(Move& move);
-    void makeMoveCastlingChecks(Move& move);
+    void undoLastMoveSnapshot();
+    void undoLastMoveIncremental();
 };
\ No newline at end of file
@@ -1,23 +1,33 @@
 #include "engine.h"
 
 #include <algorithm>
+#include <array>
 #include <bitset>
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 #include "../lib/logger/logger.h"
+#include "../lib/thread-pool/thread-pool.h"
+#include "./attacks/attacks.h"
 #include "./masks/masks.h"
+#include "./search/score.h"
+
+// Serialises lines written by the input and the search threads
+void sendUCI(const std::string& line) {
+    static std::mutex outputMutex;
+    std::lock_guard<std::mutex> lock(outputMutex);
+    std::cout << line << std::endl;
+}
 
 void Engine::init() {
-    generatePawnMaskAttacks();
-    generateKnightMaskMoves();
-    generateKingMaskMoves();
-    generateSliderPiecesAttacks(IS_BISHOP);
-    generateSliderPiecesAttacks(IS_ROOK);
+    transpositionTable = std::make_shared<TranspositionTable>();
 }
 
 void Engine::emptyBoard() { board.emptyBoard(); }
@@ -32,515 +42,6 @@ void Engine::parseFEN(const std::string FEN) {
     board.parseFEN(FEN);
 }
 
-#pragma region pawns
-
-Bitboard whitePawnWestAttack(Bitboard pawn) { return (pawn & notAFile) >> 7; }
-Bitboard whitePawnEastAttack(Bitboard pawn) { return (pawn & notHFile) >> 9; }
-
-Bitboard blackPawnWestAttack(Bitboard pawn) { return (pawn & notAFile) << 9; }
-Bitboard blackPawnEastAttack(Bitboard pawn) { return (pawn & notHFile) << 7; }
-
-Bitboard Engine::generateSinglePawnMaskAttacks(Square square, Color color) {
-    Bitboard squareBitboard;
-    squareBitboard.setBit(square);
-
-    Bitboard attacks;
-
-    if (color == WHITE) {
-        attacks |= whitePawnWestAttack(squareBitboard);
-        attacks |= whitePawnEastAttack(squareBitboard);
-    } else {
-        attacks |= blackPawnWestAttack(squareBitboard);
-        attacks |= blackPawnEastAttack(squareBitboard);
-    }
-
-    return attacks;
-}
-
-void Engine::generatePawnMaskAttacks() {
-    for (int square = 0; square < 64; square++) {
-        pawnAttacksMasks[WHITE][square] =
-            generateSinglePawnMaskAttacks(static_cast<Square>(square), WHITE);
-        pawnAttacksMasks[BLACK][square] =
-            generateSinglePawnMaskAttacks(static_cast<Square>(square), BLACK);
-    }
-}
-
-inline Bitboard Engine::getSinglePawnAttacks(Square square, Color color) {
-    return pawnAttacksMasks[color][square];
-}
-
-#pragma endregion pawns
-
-#pragma region knights
-
-Bitboard knightNoNoEa(Bitboard knight) { return (knight & notHFile) >> 17; }
-Bitboard knightNoEaEa(Bitboard knight) { return (knight & notGHFile) >> 10; }
-Bitboard knightSoEaEa(Bitboard knight) { return (knight & notGHFile) << 6; }
-Bitboard knightSoSoEa(Bitboard knight) { return (knight & notHFile) << 15; }
-Bitboard knightNoNoWe(Bitboard knight) { return (knight & notAFile) >> 15; }
-Bitboard knightNoWeWe(Bitboard knight) { return (knight & notABFile) >> 6; }
-Bitboard knightSoWeWe(Bitboard knight) { return (knight & notABFile) << 10; }
-Bitboard knightSoSoWe(Bitboard knight) { return (knight & notAFile) << 17; }
-
-Bitboard Engine::generateSingleKnightAttacksMask(Square square) {
-    Bitboard squareBitboard;
-    squareBitboard.setBit(square);
-
-    Bitboard moves;
-
-    moves |= knightNoNoEa(squareBitboard);
-    moves |= knightNoEaEa(squareBitboard);
-    moves |= knightSoEaEa(squareBitboard);
-    moves |= knightSoSoEa(squareBitboard);
-    moves |= knightNoNoWe(squareBitboard);
-    moves |= knightNoWeWe(squareBitboard);
-    moves |= knightSoWeWe(squareBitboard);
-    moves |= knightSoSoWe(squareBitboard);
-
-    return moves;
-}
-
-void Engine::generateKnightMaskMoves() {
-    for (int square = 0; square < 64; square++) {
-        knightAttacksMasks[square] =
-            generateSingleKnightAttacksMask(static_cast<Square>(square));
-    }
-}
-
-inline Bitboard Engine::getSingleKnightAttacks(Square square) {
-    return knightAttacksMasks[square];
-}
-
-#pragma endregion
-
-#pragma region King
-
-Bitboard kingNoWe(Bitboard king) { return (king & notAFile) >> 7; }
-Bitboard kingNo(Bitboard king) { return king >> 8; }
-Bitboard KingNoEa(Bitboard king) { return (king & notHFile) >> 9; }
-Bitboard KingEa(Bitboard king) { return (king & notHFile) >> 1; }
-Bitboard kingSoEa(Bitboard king) { return (king & notHFile) << 7; }
-Bitboard kingSo(Bitboard king) { return king << 8; }
-Bitboard kingSoWe(Bitboard king) { return (king & notAFile) << 9; }
-Bitboard kingWe(Bitboard king) { return (king & notAFile) << 1; }
-
-Bitboard Engine::generateSingleKingAttacksMask(Square square) {
-    Bitboard squareBitboard;
-    squareBitboard.setBit(square);
-
-    Bitboard moves;
-    moves |= kingNoWe(squareBitboard);
-    moves |= kingNo(squareBitboard);
-    moves |= KingNoEa(squareBitboard);
-    moves |= KingEa(squareBitboard);
-    moves |= kingSoEa(squareBitboard);
-    moves |= kingSo(squareBitboard);
-    moves |= kingSoWe(squareBitboard);
-    moves |= kingWe(squareBitboard);
-
-    return moves;
-}
-
-void Engine::generateKingMaskMoves() {
-    for (int square = 0; square < 64; square++) {
-        kingAttacksMasks[square] =
-            generateSingleKingAttacksMask(static_cast<Square>(square));
-    }
-}
-
-inline Bitboard Engine::getSingleKingAttacks(Square square) {
-    return kingAttacksMasks[square];
-}
-
-#pragma endregion
-
-#pragma region Bishops
-
-Bitboard northEastRelevantOccupancies(Square square) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank + 1, file = pieceFile + 1; rank <= 6 && file <= 6;
-         rank++, file++) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
-        mask |= tMask;
-    }
-    return mask;
-}
-
-Bitboard southEastRelevantOccupancies(Square square) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank - 1, file = pieceFile + 1; rank >= 1 && file <= 6;
-         rank--, file++) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
-        mask |= tMask;
-    }
-    return mask;
-}
-
-Bitboard northWestRelevantOccupancies(Square square) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank + 1, file = pieceFile - 1; rank <= 6 && file >= 1;
-         rank++, file--) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
-        mask |= tMask;
-    }
-    return mask;
-}
-
-Bitboard southWestRelevantOccupancies(Square square) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank - 1, file = pieceFile - 1; rank >= 1 && file >= 1;
-         rank--, file--) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
-        mask |= tMask;
-    }
-    return mask;
-}
-
-Bitboard Engine::generateSingleBishopRelevantOccupanciesMask(Square square) {
-    Bitboard mask;
-    mask |= northEastRelevantOccupancies(square);
-    mask |= southEastRelevantOccupancies(square);
-    mask |= northWestRelevantOccupancies(square);
-    mask |= southWestRelevantOccupancies(square);
-
-    return mask;
-}
-
-Bitboard bishopNorthEastAttacks(Square square, Bitboard blocks) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank + 1, file = pieceFile + 1; rank < 8 && file < 8;
-         rank++, file++) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
-        mask |= tMask;
-
-        if (!(blocks & tMask).isEmpty()) {
-            break;
-        }
-    }
-    return mask;
-}
-
-Bitboard bishopSouthEastAttacks(Square square, Bitboard blocks) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank - 1, file = pieceFile + 1; rank >= 0 && file < 8;
-         rank--, file++) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
-        mask |= tMask;
-
-        if (!(blocks & tMask).isEmpty()) {
-            break;
-        }
-    }
-
-    return mask;
-}
-
-Bitboard bishopNorthWestAttacks(Square square, Bitboard blocks) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank + 1, file = pieceFile - 1; rank < 8 && file >= 0;
-         rank++, file--) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
-        mask |= tMask;
-
-        if (!(blocks & tMask).isEmpty()) {
-            break;
-        }
-    }
-    return mask;
-}
-
-Bitboard bishopSouthWestAttacks(Square square, Bitboard blocks) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank - 1, file = pieceFile - 1; rank >= 0 && file >= 0;
-         rank--, file--) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + file);
-        mask |= tMask;
-
-        if (!(blocks & tMask).isEmpty()) {
-            break;
-        }
-    }
-    return mask;
-}
-
-Bitboard Engine::generateSingleBishopAttacks(Square square, Bitboard blocks) {
-    Bitboard attacks;
-    attacks |= bishopNorthEastAttacks(square, blocks);
-    attacks |= bishopSouthEastAttacks(square, blocks);
-    attacks |= bishopNorthWestAttacks(square, blocks);
-    attacks |= bishopSouthWestAttacks(square, blocks);
-
-    return attacks;
-}
-
-inline Bitboard Engine::getSingleBishopAttacks(Square square,
-                                               Bitboard occupancies) {
-    Bitboard t1 = occupancies & bishopRelevantOccupanciesMasks[square];
-    Bitboard t2 = Bitboard(t1.getValue() * bishopMagicNumbers[square]);
-    Bitboard t3 = Bitboard(t2.getValue() >>
-                           (64 - bishopRelevantOccupanciesCounts[square]));
-    return bishopAttacksTable[square][t3.getValue()];
-}
-
-#pragma endregion
-
-#pragma region Rooks
-
-Bitboard northRelevantOccupancies(Square square) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank + 1; rank < 7; rank++) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + pieceFile);
-        mask |= tMask;
-    }
-    return mask;
-}
-
-Bitboard southRelevantOccupancies(Square square) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank - 1; rank > 0; rank--) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + pieceFile);
-        mask |= tMask;
-    }
-    return mask;
-}
-
-Bitboard westRelevantOccupancies(Square square) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int file = pieceFile - 1; file > 0; file--) {
-        Bitboard tMask = Bitboard::fromSquare(pieceRank * 8 + file);
-        mask |= tMask;
-    }
-    return mask;
-}
-
-Bitboard eastRelevantOccupancies(Square square) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int file = pieceFile + 1; file < 7; file++) {
-        Bitboard tMask = Bitboard::fromSquare(pieceRank * 8 + file);
-        mask |= tMask;
-    }
-    return mask;
-}
-
-Bitboard Engine::generateSingleRookRelevantOccupanciesMask(Square square) {
-    Bitboard mask;
-    mask |= northRelevantOccupancies(square);
-    mask |= southRelevantOccupancies(square);
-    mask |= westRelevantOccupancies(square);
-    mask |= eastRelevantOccupancies(square);
-
-    return mask;
-}
-
-Bitboard rookNorthAttacks(Square square, Bitboard blocks) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank + 1; rank < 8; rank++) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + pieceFile);
-        mask |= tMask;
-
-        if (!(blocks & tMask).isEmpty()) {
-            break;
-        }
-    }
-    return mask;
-}
-
-Bitboard rookSouthAttacks(Square square, Bitboard blocks) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int rank = pieceRank - 1; rank >= 0; rank--) {
-        Bitboard tMask = Bitboard::fromSquare(rank * 8 + pieceFile);
-        mask |= tMask;
-
-        if (!(blocks & tMask).isEmpty()) {
-            break;
-        }
-    }
-    return mask;
-}
-
-Bitboard rookWestAttacks(Square square, Bitboard blocks) {
-    Bitboard mask;
-
-    int pieceRank = square / 8;
-    int pieceFile = square % 8;
-
-    for (int file = pieceFile - 1; file >= 0; file--) {
-        Bitboard tMask = Bitboard::fromSquare(pieceRank * 8 + file);
-        mask |= tMask;
-
-        if (!(blocks & tMask).isEmpty()) {
-            break;
-        }
-    }
-    return mask;
-}
-
-Bitboard rookEastAttacks(Square square, Bitboard blocks) {
-    Bitboard mask;
-
-    int pieceFile = square % 8;
-    int pieceRank = square / 8;
-
-    for (int file = pieceFile + 1; file < 8; file++) {
-        Bitboard tMask = Bitboard::fromSquare(pieceRank * 8 + file);
-        mask |= tMask;
-
-        if (!(blocks & tMask).isEmpty()) {
-            break;
-        }
-    }
-    return mask;
-}
-
-Bitboard Engine::generateSingleRookAttacks(Square square, Bitboard blocks) {
-    Bitboard attacks;
-    attacks |= rookNorthAttacks(square, blocks);
-    attacks |= rookSouthAttacks(square, blocks);
-    attacks |= rookWestAttacks(square, blocks);
-    attacks |= rookEastAttacks(square, blocks);
-
-    return attacks;
-}
-
-inline Bitboard Engine::getSingleRookAttacks(Square square,
-                                             Bitboard occupancies) {
-    Bitboard t1 = occupancies & rookRelevantOccupanciesMasks[square];
-    Bitboard t2 = Bitboard(t1.getValue() * rookMagicNumbers[square]);
-    Bitboard t3 =
-        Bitboard(t2.getValue() >> (64 - rookRelevantOccupanciesCounts[square]));
-    return rookAttacksTable[square][t3.getValue()];
-}
-
-#pragma endregion
-
-#pragma region Sliding Pieces Logic
-
-Bitboard Engine::setOccupancy(int index, Bitboard attacksMask) {
-    Bitboard occupancyMask;
-    int attacksMaskPopCount = attacksMask.popCount();
-
-    for (int count = 0; count < attacksMaskPopCount; count++) {
-        int square = attacksMask.leastSignificantBeatIndex();
-        attacksMask.clearBit(square);
-
-        if (index & (1 << count)) {
-            occupancyMask |= Bitboard::fromSquare(square);
-        }
-    }
-
-    return occupancyMask;
-};
-
-void Engine::generateSliderPiecesAttacks(SlidingPiece piece) {
-    for (int square = 0; square < 64; square++) {
-        bishopRelevantOccupanciesMasks[square] =
-            generateSingleBishopRelevantOccupanciesMask(
-                static_cast<Square>(square));
-        rookRelevantOccupanciesMasks[square] =
-            generateSingleRookRelevantOccupanciesMask(
-                static_cast<Square>(square));
-
-        Bitboard attackMask = piece == IS_BISHOP
-                                  ? bishopRelevantOccupanciesMasks[square]
-                                  : rookRelevantOccupanciesMasks[square];
-
-        int relevantOccupanciesBits = attackMask.popCount();
-        int occupancyIndices = (1 << relevantOccupanciesBits);
-
-        for (int index = 0; index < occupancyIndices; index++) {
-            if (piece == IS_BISHOP) {
-                Bitboard occupancy = setOccupancy(index, attackMask);
-                int magicIndex =
-                    (occupancy.getValue() * bishopMagicNumbers[square]) >>
-                    (64 - bishopRelevantOccupanciesCounts[square]);
-                bishopAttacksTable[square][magicIndex] =
-                    generateSingleBishopAttacks(static_cast<Square>(square),
-                                                occupancy);
-            } else {
-                Bitboard occupancy = setOccupancy(index, attackMask);
-                int magicIndex =
-                    (occupancy.getValue() * rookMagicNumbers[square]) >>
-                    (64 - rookRelevantOccupanciesCounts[square]);
-                rookAttacksTable[square][magicIndex] =
-                    generateSingleRookAttacks(static_cast<Square>(square),
-                                              occupancy);
-            }
-        }
-    }
-}
-
-#pragma endregion
-
-#pragma region Queen
-
-inline Bitboard Engine::getSingleQueenAttacks(Square square,
-                                              Bitboard occupancies) {
-    Bitboard attacks;
-    attacks |= getSingleBishopAttacks(square, occupancies);
-    attacks |= getSingleRookAttacks(square, occupancies);
-
-    return attacks;
-}
-
-#pragma endregion
-
 #pragma region Attacks
 
 bool Engine::isSquareUnderAttackBy(Square square, Color color) {
@@ -614,7 +115,7 @@ bool isOnRank(Square square, int rank) {
     return (square >= (rank - 1) * 8) && (square < rank * 8);
 }
 
-void addPromotionMoves(Square from, Square to, std::vector<u_int32_t>& moves) {
+void addPromotionMoves(Square from, Square to, MoveList& moves) {
     bool isCapture = from % 8 != to % 8;
 
     moves.push_back(Move::createBinary(
@@ -633,7 +134,7 @@ void addPromotionMoves(Square from, Square to, std::vector<u_int32_t>& moves) {
                                            : PAWN_PROMOTION_TO_KNIGHT));
 }
 
-void addPawnPushMove(Square from, Square to, std::vector<u_int32_t>& moves) {
+void addPawnPushMove(Square from, Square to, MoveList& moves) {
     bool isCapture = from % 8 != to % 8;
     bool isDoublePush = (!isCapture) && (abs((to / 8) - (from / 8)) == 2);
     MoveType moveType = isDoublePush ? PAWN_DOUBLE_PUSH
@@ -643,7 +144,7 @@ void addPawnPushMove(Square from, Square to, std::vector<u_int32_t>& moves) {
 
 void generateWhitePawnCaptures(const ChessboardStatus* const status,
                                Square from, Square to,
-                               std::vector<u_int32_t>& moves) {
+                               MoveList& moves) {
     if (to == status->enpassant) {
         moves.push_back(Move::createBinary(from, to, PAWN_CAPTURE_ENPASSANT));
         return;
@@ -658,7 +159,7 @@ void generateWhitePawnCaptures(const ChessboardStatus* const status,
 
 void generateBlackPawnCaptures(const ChessboardStatus* const status,
                                Square from, Square to,
-                               std::vector<u_int32_t>& moves) {
+                               MoveList& moves) {
     if (to == status->enpassant) {
         moves.push_back(Move::createBinary(from, to, PAWN_CAPTURE_ENPASSANT));
         return;
@@ -673,7 +174,7 @@ void generateBlackPawnCaptures(const ChessboardStatus* const status,
 }
 
 void generateWhitePawnQuietMoves(const ChessboardStatus* const status,
-                                 Square from, std::vector<u_int32_t>& moves) {
+                                 Square from, MoveList& moves) {
     const Bitboard& allPieces = status->boards[ALL_PIECES];
     Square to = static_cast<Square>(from + 8);
 
@@ -697,7 +198,7 @@ void generateWhitePawnQuietMoves(const ChessboardStatus* const status,
 }
 
 void generateBlackPawnQuietMoves(const ChessboardStatus* const status,
-                                 Square from, std::vector<u_int32_t>& moves) {
+                                 Square from, MoveList& moves) {
     const Bitboard& allPieces = status->boards[ALL_PIECES];
     Square to = static_cast<Square>(from - 8);
 
@@ -720,7 +221,75 @@ void generateBlackPawnQuietMoves(const ChessboardStatus* const status,
     }
 }
 
-void Engine::generatePawnMoves(std::vector<u_int32_t>& moves) {
+// Targets of a whole pawn set, each coming from offset squares behind
+void addPawnMoves(Bitboard targets, int offset, MoveType moveType,
+                  MoveList& moves) {
+    while (!targets.isEmpty()) {
+        int to = targets.leastSignificantBeatIndex();
+        moves.push_back(Move::createBinary(static_cast<Square>(to - offset),
+                                           static_cast<Square>(to), moveType));
+        targets.clearBit(to);
+    }
+}
+
+void addPawnPromotions(Bitboard targets, int offset, MoveList& moves) {
+    while (!targets.isEmpty()) {
+        int to = targets.leastSignificantBeatIndex();
+        addPromotionMoves(static_cast<Square>(to - offset),
+                          static_cast<Square>(to), moves);
+        targets.clearBit(to);
+    }
+}
+
+void Engine::generatePawnMoves(MoveList& moves, GeneratedMoves type) {
+    const Bitboard* boards = board.status.boards;
+    bool isWhite = board.status.side.value() == WHITE;
+    Bitboard pawns = boards[isWhite ? WHITE_PAWNS : BLACK_PAWNS];
+    Bitboard empty = ~boards[ALL_PIECES];
+    Bitboard enemies = boards[isWhite ? BLACK_ALL : WHITE_ALL];
+    Bitboard promotionRank = isWhite ? eighthRank : firstRank;
+
+    // Square offsets of every pawn move, bits run the opposite way
+    int push = isWhite ? 8 : -8;
+    int west = isWhite ? 7 : -9;
+    int east = isWhite ? 9 : -7;
+
+    Bitboard pushes = (isWhite ? pawns >> 8 : pawns << 8) & empty;
+    Bitboard doublePushes =
+        (isWhite ? (pushes & thirdRank) >> 8 : (pushes & sixthRank) << 8) &
+        empty;
+    Bitboard westAttacks =
+        isWhite ? whitePawnWestAttack(pawns) : blackPawnWestAttack(pawns);
+    Bitboard eastAttacks =
+        isWhite ? whitePawnEastAttack(pawns) : blackPawnEastAttack(pawns);
+
+    // Promotions, even quiet ones, come with the captures
+    if (type != QUIET_MOVES) {
+        Bitboard captures = enemies & ~promotionRank;
+
+        addPawnPromotions(westAttacks & enemies & promotionRank, west, moves);
+        addPawnPromotions(eastAttacks & enemies & promotionRank, east, moves);
+        addPawnPromotions(pushes & promotionRank, push, moves);
+        addPawnMoves(westAttacks & captures, west, PAWN_CAPTURE, moves);
+        addPawnMoves(eastAttacks & captures, east, PAWN_CAPTURE, moves);
+
+        if (board.status.enpassant.has_value()) {
+            Bitboard enpassant =
+                Bitboard::fromSquare(board.status.enpassant.value());
+            addPawnMoves(westAttacks & enpassant, west,
+                         PAWN_CAPTURE_ENPASSANT, moves);
+            addPawnMoves(eastAttacks & enpassant, east,
+                         PAWN_CAPTURE_ENPASSANT, moves);
+        }
+    }
+
+    if (type != CAPTURE_MOVES) {
+        addPawnMoves(pushes & ~promotionRank, push, PAWN_PUSH, moves);
+        addPawnMoves(doublePushes, push * 2, PAWN_DOUBLE_PUSH, moves);
+    }
+}
+
+void Engine::generatePawnMovesPerSquare(MoveList& moves) {
     Color sideToMove = board.status.side.value();
     PieceBoard pawnPiece = (sideToMove == WHITE) ? WHITE_PAWNS : BLACK_PAWNS;
     Bitboard pawns = board.status.boards[pawnPiece];
@@ -735,7 +304,7 @@ void Engine::generatePawnMoves(std::vector<u_int32_t>& moves) {
 }
 
 void Engine::generatePawnQuietMoves(Square from,
-                                    std::vector<u_int32_t>& moves) {
+                                    MoveList& moves) {
     Color sideToMove = board.status.side.value();
     if (sideToMove == WHITE) {
         generateWhitePawnQuietMoves(&board.status, from, moves);
@@ -745,15 +314,15 @@ void Engine::generatePawnQuietMoves(Square from,
 }
 
 void Engine::generatePawnCaptureMoves(Square from,
-                                      std::vector<u_int32_t>& moves) {
+                                      MoveList& moves) {
     Color sideToMove = board.status.side.value();
     PieceBoard attackedSide = (sideToMove == WHITE) ? BLACK_ALL : WHITE_ALL;
-    Bitboard attacks =
-        pawnAttacksMasks[sideToMove][from] & board.status.boards[attackedSide];
+    Bitboard attacks = getSinglePawnAttacks(from, sideToMove) &
+                       board.status.boards[attackedSide];
 
     Bitboard enpassantAttacks;
     if (board.status.enpassant.has_value()) {
-        enpassantAttacks = pawnAttacksMasks[sideToMove][from] &
+        enpassantAttacks = getSinglePawnAttacks(from, sideToMove) &
                            Bitboard::fromSquare(board.status.enpassant.value());
     }
 
@@ -770,9 +339,11 @@ void Engine::generatePawnCaptureMoves(Square from,
     }
 }
 
-void Engine::generateKingMoves(std::vector<u_int32_t>& moves) {
-    generateSliderAndLeaperMoves(KING, moves);
-    generateKingCastlingMoves(moves);
+void Engine::generateKingMoves(MoveList& moves, GeneratedMoves type) {
+    generateSliderAndLeaperMoves(KING, moves, type);
+    if (type != CAPTURE_MOVES) {
+        generateKingCastlingMoves(moves);
+    }
 }
 
 bool Engine::canWhiteCastleKingSide() {
@@ -837,7 +408,7 @@ bool Engine::canBlackCastleQueenSide() {
     return (emptyRank && noAttacks);
 }
 
-void Engine::generateKingCastlingMoves(std::vector<u_int32_t>& moves) {
+void Engine::generateKingCastlingMoves(MoveList& moves) {
     Color sideToMove = board.status.side.value();
 
     if (sideToMove == WHITE) {
@@ -878,35 +449,41 @@ Bitboard Engine::getAttacksBoard(Piece piece, Square square) {
     }
 }
 
-MoveType getMoveType(Piece piece, bool isQuiet) {
-    const std::map<Piece, MoveType> captureMoveMap = {
-        {KNIGHT, KNIGHT_CAPTURE}, {KING, KING_CAPTURE},
-        {ROOK, ROOK_CAPTURE},     {QUEEN, QUEEN_CAPTURE},
-        {BISHOP, BISHOP_CAPTURE},
-    };
+// Indexed by Piece
+constexpr MoveType captureMoveTypes[6] = {
+    PAWN_CAPTURE,   ROOK_CAPTURE,  KNIGHT_CAPTURE,
+    BISHOP_CAPTURE, QUEEN_CAPTURE, KING_CAPTURE,
+};
 
-    const std::map<Piece, MoveType> quietMoveMap = {
-        {KNIGHT, KNIGHT_QUIET}, {KING, KING_QUIET},     {ROOK, ROOK_QUIET},
-        {QUEEN, QUEEN_QUIET},   {BISHOP, BISHOP_QUIET},
-    };
+constexpr MoveType quietMoveTypes[6] = {
+    PAWN_PUSH,    ROOK_QUIET,  KNIGHT_QUIET,
+    BISHOP_QUIET, QUEEN_QUIET, KING_QUIET,
+};
 
-    return isQuiet ? quietMoveMap.at(piece) : captureMoveMap.at(piece);
+MoveType getMoveType(Piece piece, bool isQuiet) {
+    return isQuiet ? quietMoveTypes[piece] : captureMoveTypes[piece];
 }
 
-void Engine::generateSliderAndLeaperMoves(Piece piece,
-                                          std::vector<u_int32_t>& moves) {
+void Engine::generateSliderAndLeaperMoves(Piece piece, MoveList& moves,
+                                          GeneratedMoves type) {
     Color sideToMove = board.status.side.value();
 
     Bitboard pieceBoard =
-        board.status.boards[sideColorToPieceBoardMap.at({sideToMove, piece})];
+        board.status.boards[pieceBoardOf(piece, sideToMove)];
     PieceBoard sideBoard = (sideToMove == WHITE) ? WHITE_ALL : BLACK_ALL;
     PieceBoard opponentBoard = (sideToMove == WHITE) ? BLACK_ALL : WHITE_ALL;
 
+    Bitboard targets = ~board.status.boards[sideBoard];
+    if (type == CAPTURE_MOVES) {
+        targets = board.status.boards[opponentBoard];
+    } else if (type == QUIET_MOVES) {
+        targets = ~board.status.boards[ALL_PIECES];
+    }
+
     while (pieceBoard.getValue()) {
         Square from =
             static_cast<Square>(pieceBoard.leastSignificantBeatIndex());
-        Bitboard attacks =
-            getAttacksBoard(piece, from) & ~(board.status.boards[sideBoard]);
+        Bitboard attacks = getAttacksBoard(piece, from) & targets;
 
         while (attacks.getValue()) {
             Square to =
@@ -927,21 +504,23 @@ void Engine::generateSliderAndLeaperMoves(Piece piece,
     }
 }
 
-std::vector<u_int32_t> Engine::generateAllPseudoLegalMoves() {
-    std::vector<u_int32_t> moves;
-
-    generatePawnMoves(moves);
-    generateKingMoves(moves);
-    generateSliderAndLeaperMoves(KNIGHT, moves);
-    generateSliderAndLeaperMoves(BISHOP, moves);
-    generateSliderAndLeaperMoves(ROOK, moves);
-    generateSliderAndLeaperMoves(QUEEN, moves);
-
+MoveList Engine::generateAllPseudoLegalMoves(GeneratedMoves type) {
+    MoveList moves;
+    generatePseudoLegalMoves(moves, type);
     return moves;
 }
 
+void Engine::generatePseudoLegalMoves(MoveList& moves, GeneratedMoves type) {
+    generatePawnMoves(moves, type);
+    generateKingMoves(moves, type);
+    generateSliderAndLeaperMoves(KNIGHT, moves, type);
+    generateSliderAndLeaperMoves(BISHOP, moves, type);
+    generateSliderAndLeaperMoves(ROOK, moves, type);
+    generateSliderAndLeaperMoves(QUEEN, moves, type);
+}
+
 std::vector<Move> Engine::generateAllPseudoLegalMovesAsMoveList() {
-    std::vector<u_int32_t> binaryMoves = generateAllPseudoLegalMoves();
+    MoveList binaryMoves = generateAllPseudoLegalMoves();
     std::vector<Move> moves;
     moves.reserve(binaryMoves.size());
     for (u_int32_t binary : binaryMoves) {
@@ -963,7 +542,22 @@ void Engine::__printMoves(std::vector<Move> moves) {
     logger.info(oss.str());
 }
 
-bool Engine::makeMove(Move move) {
+MoveList Engine::generateMoves() {
+    return generationMode == GENERATE_LEGAL ? generateLegalMoves()
+                                            : generateAllPseudoLegalMoves();
+}
+
+bool Engine::makeGeneratedMove(u_int32_t move) {
+    if (generationMode == GENERATE_LEGAL) {
+        board.makePsuedoLegalMove(move);
+        return true;
+    }
+    return makeMove(move);
+}
+
+bool Engine::makeMove(Move move) { return makeMove(move.toBinary()); }
+
+bool Engine::makeMove(u_int32_t move) {
     board.makePsuedoLegalMove(move);
 
     bool isLegalMove =
@@ -972,7 +566,10 @@ bool Engine::makeMove(Move move) {
                                    // made a legal move
 
     if (!isLegalMove) {
-        logger.debug("Not a legal move(" + move.toStringUCI() + "), undo!");
+        if (logger.isEnabled(DEBUG)) {
+            logger.debug("Not a legal move(" + Move(move).toStringUCI() +
+                         "), undo!");
+        }
         board.undoLastMove();
     }
     return isLegalMove;
@@ -1005,113 +602,1032 @@ inline bool Engine::isOpponentKingInCheck() {
 
 #pragma endregion
 
-#pragma region Move Search
-
-int Engine::negamax_(int alpha, int beta, int depth,
-                     uint32_t* outBestMove_pointer, int* ply_pointer) {
-    if (depth == 0) {
-        return evaluatePosition();
+#pragma region Legal move generation
+
+Bitboard Engine::attackersTo(Square square, Color color,
+                             Bitboard occupancies) {
+    const Bitboard* boards = board.status.boards;
+    Color opponent = color == WHITE ? BLACK : WHITE;
+    Bitboard queens = boards[pieceBoardOf(QUEEN, color)];
+
+    return (getSinglePawnAttacks(square, opponent) &
+            boards[pieceBoardOf(PAWN, color)]) |
+           (getSingleKnightAttacks(square) &
+            boards[pieceBoardOf(KNIGHT, color)]) |
+           (getSingleKingAttacks(square) & boards[pieceBoardOf(KING, color)]) |
+           (getSingleBishopAttacks(square, occupancies) &
+            (boards[pieceBoardOf(BISHOP, color)] | queens)) |
+           (getSingleRookAttacks(square, occupancies) &
+            (boards[pieceBoardOf(ROOK, color)] | queens));
+}
+
+Engine::LegalityMasks Engine::computeLegalityMasks() {
+    const Bitboard* boards = board.status.boards;
+    Color us = board.status.side.value();
+    Color them = us == WHITE ? BLACK : WHITE;
+    Bitboard occupancies = boards[ALL_PIECES];
+    Bitboard theirs = boards[them == WHITE ? WHITE_ALL : BLACK_ALL];
+    Bitboard queens = boards[pieceBoardOf(QUEEN, them)];
+
+    LegalityMasks masks;
+    masks.king = static_cast<Square>(
+        boards[pieceBoardOf(KING, us)].leastSignificantBeatIndex());
+    masks.checkers = attackersTo(masks.king, them, occupancies);
+    masks.checkMask = ~Bitboard();
+
+    if (masks.checkers.popCount() == 1) {
+        Square checker =
+            static_cast<Square>(masks.checkers.leastSignificantBeatIndex());
+        masks.checkMask =
+            attacks_->betweenMasks[masks.king][checker] | masks.checkers;
+    }
+
+    // Their sliders seeing the king through our pieces only: a single piece
+    // of ours in between is pinned
+    Bitboard snipers = (getSingleRookAttacks(masks.king, theirs) &
+                        (boards[pieceBoardOf(ROOK, them)] | queens)) |
+                       (getSingleBishopAttacks(masks.king, theirs) &
+                        (boards[pieceBoardOf(BISHOP, them)] | queens));
+
+    while (!snipers.isEmpty()) {
+        Square sniper =
+            static_cast<Square>(snipers.leastSignificantBeatIndex());
+        Bitboard blockers =
+            attacks_->betweenMasks[masks.king][sniper] & occupancies;
+        if (blockers.popCount() == 1) {
+            masks.pinned |= blockers;
+        }
+        snipers.clearBit(sniper);
     }
 
-    std::vector<u_int32_t> moves = generateAllPseudoLegalMoves();
-
-    int legalMoves = 0;
+    return masks;
+}
 
-    for (u_int32_t move : moves) {
-        if (!makeMove(Move{move})) {
-            continue;
-        }
+bool Engine::isLegal(u_int32_t move, const LegalityMasks& masks) {
+    Square from = static_cast<Square>(move & 0x3f);
+    Square to = static_cast<Square>((move >> 6) & 0x3f);
+    Piece piece = static_cast<Piece>((move >> 12) & 0xf);
+    bool isEnpassant = (move >> 22) & 1;
 
-        (*ply_pointer)++;
-        legalMoves++;
+    Color us = board.status.side.value();
+    Color them = us == WHITE ? BLACK : WHITE;
+    Bitboard occupancies = board.status.boards[ALL_PIECES];
 
-        int score = -negamax_(-beta, -alpha, depth - 1, nullptr,
-                              ply_pointer);  // bestMove needed only at level 1
-        undoMove();
-        (*ply_pointer)--;
+    if (piece == KING) {
+        // The king must not hide behind itself from a slider, castling
+        // path squares are already checked by the generator
+        occupancies.clearBit(from);
+        return attackersTo(to, them, occupancies).isEmpty();
+    }
 
-        if (score >= beta) {
-            return beta;
-        }
-        if (score > alpha) {
-            alpha = score;
-            if (outBestMove_pointer) {
-                *outBestMove_pointer = move;
-            }
-        }
+    if (masks.checkers.popCount() > 1) {
+        return false;
     }
 
-    if (!legalMoves) {
-        if (isMyKingInCheck()) {
-            return -49000 + (*ply_pointer);
-        } else {
-            return 0;
+    if (isEnpassant) {
+        Square captured = static_cast<Square>(to + (us == WHITE ? -8 : 8));
+        if (!masks.checkers.isEmpty() && !masks.checkers.getBit(captured) &&
+            !masks.checkMask.getBit(to)) {
+            return false;
         }
-    }
+
+        // Two pawns leave the rank at once, a pin on either can be
+        // discovered, so look at the sliders on the board after the capture
+        occupancies.clearBit(from);
+        occupancies.clearBit(captured);
+        occupancies.setBit(to);
+        const Bitboard* boards = board.status.boards;
+        Bitboard queens = boards[pieceBoardOf(QUEEN, them)];
+
+        return ((getSingleRookAttacks(masks.king, occupancies) &
+                 (boards[pieceBoardOf(ROOK, them)] | queens)) |
+                (getSingleBishopAttacks(masks.king, occupancies) &
+                 (boards[pieceBoardOf(BISHOP, them)] | queens)))
+            .isEmpty();
+    }
+
+    if (!masks.checkMask.getBit(to)) {
+        return false;
+    }
+
+    // A pinned piece may only move along the line through its king
+    return !masks.pinned.getBit(from) ||
+           attacks_->betweenMasks[masks.king][to].getBit(from) ||
+           attacks_->betweenMasks[masks.king][from].getBit(to);
+}
+
+MoveList Engine::generateLegalMoves(GeneratedMoves type) {
+    MoveList moves;
+    generateLegalMoves(computeLegalityMasks(), moves, type);
+    return moves;
+}
+
+void Engine::generateLegalMoves(const LegalityMasks& masks, MoveList& moves,
+                                GeneratedMoves type) {
+    size_t firstMove = moves.size();
+
+    // In double check only the king can move
+    if (masks.checkers.popCount() > 1) {
+        generateSliderAndLeaperMoves(KING, moves, type);
+    } else {
+        generatePseudoLegalMoves(moves, type);
+    }
+
+    // Moves already in the list were filtered by an earlier call
+    size_t legalMoves = firstMove;
+    for (size_t index = firstMove; index < moves.size(); index++) {
+        if (isLegal(moves[index], masks)) {
+            moves[legalMoves++] = moves[index];
+        }
+    }
+    moves.resize(legalMoves);
+}
+
+#pragma endregion
+
+#pragma region Move ordering
+
+// Indexed by Piece, the king is never captured but may capture
+const int mvvLvaValues[7] = {1, 5, 3, 3, 9, 20, 0};
+
+// Bound of history scores
+const int MAX_HISTORY = 16384;
+
+bool isQuietMove(uint32_t move) {
+    return !((move >> 20) & 1) && ((move >> 16) & 0xf) == EMPTY;
+}
+
+void Engine::initMovePicker(MovePicker& picker, uint32_t hashMove, int ply,
+                            bool capturesOnly) {
+    picker.stage = STAGE_HASH_MOVE;
+    picker.capturesOnly = capturesOnly;
+    picker.hashMove = hashMove;
+    picker.killers[0] = ply < MAX_SEARCH_DEPTH ? killers[ply][0] : 0;
+    picker.killers[1] = ply < MAX_SEARCH_DEPTH ? killers[ply][1] : 0;
+    picker.killerIndex = 0;
+    picker.moves.clear();
+    picker.index = picker.end = picker.badCaptures = 0;
+    if (generationMode == GENERATE_LEGAL) {
+        picker.masks = computeLegalityMasks();
+    }
+}
+
+uint32_t Engine::nextMove(MovePicker& picker) {
+    switch (picker.stage) {
+        case STAGE_HASH_MOVE:
+            picker.stage = STAGE_GENERATE_CAPTURES;
+            if (isPlayable(picker.hashMove, picker)) {
+                return picker.hashMove;
+            }
+            picker.hashMove = 0;
+            [[fallthrough]];
+
+        case STAGE_GENERATE_CAPTURES:
+            generateStage(picker, CAPTURE_MOVES);
+            scoreCaptures(picker.moves);
+            picker.stage = STAGE_GOOD_CAPTURES;
+            [[fallthrough]];
+
+        case STAGE_GOOD_CAPTURES:
+            // Exchanges are evaluated only for the captures reached, the
+            // losing ones wait at the front of the list for the last stage
+            while (uint32_t move = pickBestMove(picker)) {
+                if (see(move)) {
+                    return move;
+                }
+                picker.moves.swap(picker.badCaptures++, picker.index - 1);
+            }
+
+            // Quiescence never searches losing captures
+            if (picker.capturesOnly) {
+                picker.stage = STAGE_DONE;
+                return 0;
+            }
+            picker.stage = STAGE_KILLERS;
+            [[fallthrough]];
+
+        case STAGE_KILLERS:
+            // Killers come from sibling nodes, they are checked like the
+            // hash move so a cutoff here never generates the quiets
+            while (picker.killerIndex < 2) {
+                uint32_t& killer = picker.killers[picker.killerIndex++];
+                if (killer != picker.hashMove && isPlayable(killer, picker)) {
+                    return killer;
+                }
+                killer = 0;
+            }
+            picker.stage = STAGE_GENERATE_QUIETS;
+            [[fallthrough]];
+
+        case STAGE_GENERATE_QUIETS:
+            picker.quiets = picker.end;
+            generateStage(picker, QUIET_MOVES);
+            scoreQuiets(picker);
+            picker.stage = STAGE_QUIETS;
+            [[fallthrough]];
+
+        case STAGE_QUIETS:
+            while (uint32_t move = pickBestMove(picker)) {
+                if (move != picker.killers[0] && move != picker.killers[1]) {
+                    return move;
+                }
+            }
+            picker.index = 0;
+            picker.end = picker.badCaptures;
+            picker.stage = STAGE_BAD_CAPTURES;
+            [[fallthrough]];
+
+        case STAGE_BAD_CAPTURES:
+            if (uint32_t move = pickBestMove(picker)) {
+                return move;
+            }
+            picker.stage = STAGE_DONE;
+            [[fallthrough]];
+
+        case STAGE_DONE:
+            return 0;
+    }
+    return 0;
+}
+
+bool Engine::isPlayable(uint32_t move, const MovePicker& picker) {
+    return move && isPseudoLegal(move) &&
+           (generationMode != GENERATE_LEGAL || isLegal(move, picker.masks));
+}
+
+// Quiets are appended after the captures, the losing ones are still to come
+void Engine::generateStage(MovePicker& picker, GeneratedMoves type) {
+    if (generationMode == GENERATE_LEGAL) {
+        generateLegalMoves(picker.masks, picker.moves, type);
+    } else {
+        generatePseudoLegalMoves(picker.moves, type);
+    }
+    picker.end = picker.moves.size();
+}
+
+// Selection sort one step at a time, most nodes need only the first moves
+uint32_t Engine::pickBestMove(MovePicker& picker) {
+    MoveList& moves = picker.moves;
+
+    while (picker.index < picker.end) {
+        size_t best = picker.index;
+        for (size_t index = picker.index + 1; index < picker.end; index++) {
+            if (moves.score(index) > moves.score(best)) {
+                best = index;
+            }
+        }
+        moves.swap(picker.index, best);
+
+        uint32_t move = moves[picker.index++];
+        if (move != picker.hashMove) {
+            return move;
+        }
+    }
+    return 0;
+}
+
+void Engine::scoreCaptures(MoveList& moves) {
+    for (size_t index = 0; index < moves.size(); index++) {
+        uint32_t move = moves[index];
+        Square to = static_cast<Square>((move >> 6) & 0x3f);
+        Piece piece = static_cast<Piece>((move >> 12) & 0xf);
+        Piece promoted = static_cast<Piece>((move >> 16) & 0xf);
+
+        // Quiet promotions and en passant find no piece on the target
+        PieceBoard victimBoard = board.status.mailbox[to];
+        Piece victim = victimBoard == NO_PIECE
+                           ? ((move >> 22) & 1 ? PAWN : EMPTY)
+                           : static_cast<Piece>(victimBoard / 2);
+
+        moves.setScore(index, (mvvLvaValues[victim] +
+                               mvvLvaValues[promoted]) * 32 -
+                                  mvvLvaValues[piece]);
+    }
+}
+
+void Engine::scoreQuiets(MovePicker& picker) {
+    MoveList& moves = picker.moves;
+    Color us = board.status.side.value();
+
+    for (size_t index = picker.quiets; index < picker.end; index++) {
+        uint32_t move = moves[index];
+        moves.setScore(index, history[us][move & 0x3f][(move >> 6) & 0x3f]);
+    }
+}
+
+// Bonuses shrink as the entry nears the bound, so it never overflows and
+// recent cutoffs weigh more than old ones
+void Engine::updateHistory(uint32_t move, int bonus) {
+    Color us = board.status.side.value();
+    int& entry = history[us][move & 0x3f][(move >> 6) & 0x3f];
+    entry += bonus - entry * std::abs(bonus) / MAX_HISTORY;
+}
+
+void Engine::ageHistory() {
+    for (auto& side : history) {
+        for (auto& from : side) {
+            for (int& entry : from) {
+                entry /= 2;
+            }
+        }
+    }
+}
+
+void Engine::storeKiller(uint32_t move, int ply) {
+    if (ply >= MAX_SEARCH_DEPTH || killers[ply][0] == move) {
+        return;
+    }
+    killers[ply][1] = killers[ply][0];
+    killers[ply][0] = move;
+}
+
+// The Piece enum is not ordered by value, ROOK comes before the minors
+constexpr Piece leastValuableFirst[6] = {
+    PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING};
+
+// Swap algorithm on the target square: the sides take turns capturing with
+// their least valuable attacker and either may stop when behind. Sliders
+// lined up behind a capturing piece join the exchange through x-rays.
+bool Engine::see(u_int32_t move, int threshold) {
+    Square from = static_cast<Square>(move & 0x3f);
+    Square to = static_cast<Square>((move >> 6) & 0x3f);
+    Piece piece = static_cast<Piece>((move >> 12) & 0xf);
+    Piece promoted = static_cast<Piece>((move >> 16) & 0xf);
+    bool isEnpassant = (move >> 22) & 1;
+    bool isCastling = (move >> 23) & 1;
+
+    if (isCastling) {
+        return threshold <= 0;
+    }
+
+    const Bitboard* boards = board.status.boards;
+    PieceBoard victim = board.status.mailbox[to];
+    int gain = victim != NO_PIECE ? materialScores[victim / 2]
+               : isEnpassant      ? materialScores[PAWN]
+                                  : 0;
+    Piece onTarget = piece;
+    if (promoted != EMPTY) {
+        gain += materialScores[promoted] - materialScores[PAWN];
+        onTarget = promoted;
+    }
+
+    // Balance over the threshold for the side which just captured, it
+    // wins if the opponent can not recapture
+    int swap = gain - threshold;
+    if (swap < 0) {
+        return false;
+    }
+
+    // Wins even losing the piece on the target square
+    swap = materialScores[onTarget] - swap;
+    if (swap <= 0) {
+        return true;
+    }
+
+    Color side = board.status.side.value();
+    Bitboard occupancies = boards[ALL_PIECES];
+    occupancies.clearBit(from);
+    occupancies.setBit(to);
+    if (isEnpassant) {
+        occupancies.clearBit(to + (side == WHITE ? -8 : 8));
+    }
+
+    Bitboard attackers = attackersTo(to, WHITE, occupancies) |
+                         attackersTo(to, BLACK, occupancies);
+    Bitboard diagonalSliders = boards[WHITE_BISHOPS] | boards[BLACK_BISHOPS] |
+                               boards[WHITE_QUEEN] | boards[BLACK_QUEEN];
+    Bitboard straightSliders = boards[WHITE_ROOKS] | boards[BLACK_ROOKS] |
+                               boards[WHITE_QUEEN] | boards[BLACK_QUEEN];
+    bool result = true;
+
+    while (true) {
+        side = side == WHITE ? BLACK : WHITE;
+        attackers &= occupancies;
+
+        Bitboard sideAttackers =
+            attackers & boards[side == WHITE ? WHITE_ALL : BLACK_ALL];
+        if (sideAttackers.isEmpty()) {
+            break;
+        }
+        result = !result;
+
+        Piece attacker = KING;
+        for (Piece candidate : leastValuableFirst) {
+            if (!(sideAttackers & boards[pieceBoardOf(candidate, side)])
+                     .isEmpty()) {
+                attacker = candidate;
+                break;
+            }
+        }
+
+        // The king can take only if nothing recaptures
+        if (attacker == KING) {
+            Bitboard theirs =
+                attackers & boards[side == WHITE ? BLACK_ALL : WHITE_ALL];
+            return theirs.isEmpty() ? result : !result;
+        }
+
+        swap = materialScores[attacker] - swap;
+        if (swap < result) {
+            break;
+        }
+
+        Square attackerSquare = static_cast<Square>(
+            (sideAttackers & boards[pieceBoardOf(attacker, side)])
+                .leastSignificantBeatIndex());
+        occupancies.clearBit(attackerSquare);
+
+        if (attacker == PAWN || attacker == BISHOP || attacker == QUEEN) {
+            attackers |=
+                getSingleBishopAttacks(to, occupancies) & diagonalSliders;
+        }
+        if (attacker == ROOK || attacker == QUEEN) {
+            attackers |=
+                getSingleRookAttacks(to, occupancies) & straightSliders;
+        }
+    }
+
+    return result;
+}
+
+// Hash moves may come from another position sharing the table slot, they
+// are checked before being played without generating anything
+bool Engine::isPseudoLegal(u_int32_t move) {
+    Square from = static_cast<Square>(move & 0x3f);
+    Square to = static_cast<Square>((move >> 6) & 0x3f);
+    Piece piece = static_cast<Piece>((move >> 12) & 0xf);
+    Piece promoted = static_cast<Piece>((move >> 16) & 0xf);
+    bool isCapture = (move >> 20) & 1;
+    bool isDoublePush = (move >> 21) & 1;
+    bool isEnpassant = (move >> 22) & 1;
+    bool isCastling = (move >> 23) & 1;
+
+    const Bitboard* boards = board.status.boards;
+    Color us = board.status.side.value();
+    Bitboard enemies = boards[us == WHITE ? BLACK_ALL : WHITE_ALL];
+
+    if (piece >= EMPTY || !boards[pieceBoardOf(piece, us)].getBit(from) ||
+        boards[us == WHITE ? WHITE_ALL : BLACK_ALL].getBit(to)) {
+        return false;
+    }
+
+    if (isCastling) {
+        MoveList castles;
+        generateKingCastlingMoves(castles);
+        return std::find(castles.begin(), castles.end(), move) != castles.end();
+    }
+
+    if (isEnpassant) {
+        return piece == PAWN && board.status.enpassant == to &&
+               getSinglePawnAttacks(from, us).getBit(to);
+    }
+
+    if (isCapture != enemies.getBit(to)) {
+        return false;
+    }
+
+    if (piece != PAWN) {
+        return promoted == EMPTY && getAttacksBoard(piece, from).getBit(to);
+    }
+
+    bool isPromotionRank = us == WHITE ? to >= a8 : to <= h1;
+    if (isPromotionRank != (promoted != EMPTY)) {
+        return false;
+    }
+    if (isCapture) {
+        return getSinglePawnAttacks(from, us).getBit(to);
+    }
+
+    int push = us == WHITE ? 8 : -8;
+    if (isDoublePush) {
+        bool isStartRank = us == WHITE ? from / 8 == 1 : from / 8 == 6;
+        return isStartRank && to == from + 2 * push &&
+               !boards[ALL_PIECES].getBit(from + push);
+    }
+    return to == from + push;
+}
+
+#pragma endregion
+
+#pragma region Move Search
+
+// Mate scores are stored relative to the node, not to the root
+int scoreToTranspositionTable(int score, int ply) {
+    if (score > MATE_BOUND) return score + ply;
+    if (score < -MATE_BOUND) return score - ply;
+    return score;
+}
+
+int scoreFromTranspositionTable(int score, int ply) {
+    if (score > MATE_BOUND) return score - ply;
+    if (score < -MATE_BOUND) return score + ply;
+    return score;
+}
+
+bool Engine::hasNonPawnMaterial_() {
+    const Bitboard* boards = board.status.boards;
+    Color us = board.status.side.value();
+    Bitboard pieces =
+        boards[pieceBoardOf(KNIGHT, us)] | boards[pieceBoardOf(BISHOP, us)] |
+        boards[pieceBoardOf(ROOK, us)] | boards[pieceBoardOf(QUEEN, us)];
+    return !pieces.isEmpty();
+}
+
+// Late move reductions by depth and move number, growing with the log of
+// both
+const auto lateMoveReductionTable = []() {
+    std::array<std::array<int, MAX_MOVES>, MAX_SEARCH_DEPTH + 1> table{};
+    for (int depth = 1; depth <= MAX_SEARCH_DEPTH; depth++) {
+        for (size_t moveNumber = 1; moveNumber < MAX_MOVES; moveNumber++) {
+            table[depth][moveNumber] =
+                (int)(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+        }
+    }
+    return table;
+}();
+
+void Engine::countNode_() {
+    nodes++;
+    if (nodes % TIME_CHECK_NODES == 0) {
+        signals->nodes.fetch_add(TIME_CHECK_NODES, std::memory_order_relaxed);
+        signals->qnodes.fetch_add(qnodes - publishedQnodes_,
+                                  std::memory_order_relaxed);
+        publishedQnodes_ = qnodes;
+
+        if (canStop_ && !isPondering_() && timeManager.hardLimitReached()) {
+            signals->stop.store(true, std::memory_order_relaxed);
+        }
+    }
+}
+
+int Engine::negamax_(int alpha, int beta, int depth,
+                     uint32_t* outBestMove_pointer, int* ply_pointer) {
+    if (depth == 0) {
+        return quiescence_(alpha, beta, *ply_pointer);
+    }
+
+    int ply = *ply_pointer;
+    pvLength_[ply] = ply;
+    seldepth_ = std::max(seldepth_, ply);
+
+    countNode_();
+    if (isStopped()) {
+        return 0;
+    }
+
+    // Null window nodes only prove a bound, PV nodes need the full line
+    bool isPvNode = beta - alpha > 1;
+
+    uint64_t key = board.status.hashKey;
+    TranspositionEntry entry;
+    uint32_t hashMove = 0;
+
+    if (transpositionTable && transpositionTable->probe(key, entry)) {
+        hashMove = entry.move;
+
+        // Never cut at the root, the caller needs a move, nor on the PV
+        if (!isPvNode && ply > 0 && entry.depth >= depth) {
+            int score = scoreFromTranspositionTable(entry.score, *ply_pointer);
+            if (entry.bound == BOUND_EXACT) {
+                return score;
+            }
+            if (entry.bound == BOUND_LOWER && score >= beta) {
+                return beta;
+            }
+            if (entry.bound == BOUND_UPPER && score <= alpha) {
+                return alpha;
+            }
+        }
+    }
+
+    bool inCheck = isMyKingInCheck();
+
+    // Null move pruning: when passing the turn still fails high, some real
+    // move would too. Never twice in a row, and never with pawns only
+    // where zugzwang makes passing the best move.
+    if (useNullMovePruning && !isPvNode && !inCheck && ply > 0 &&
+        depth >= 3 && playedMoves_[ply - 1] && hasNonPawnMaterial_() &&
+        evaluatePosition() >= beta) {
+        int reduction = 2 + depth / 6;
+        stats.nullMoveTries++;
+
+        std::optional<Square> enpassant = board.makeNullMove();
+        playedMoves_[ply] = 0;
+        (*ply_pointer)++;
+        int score = -negamax_(-beta, -beta + 1,
+                              std::max(depth - 1 - reduction, 0), nullptr,
+                              ply_pointer);
+        (*ply_pointer)--;
+        board.undoNullMove(enpassant);
+
+        if (isStopped()) {
+            return 0;
+        }
+        if (score >= beta) {
+            stats.nullMoveCutoffs++;
+            return beta;
+        }
+    }
+
+    // The leftmost path searches the previous iteration PV first
+    if (followPv_) {
+        if (ply < previousPvLength_) {
+            hashMove = previousPv_[ply];
+        } else {
+            followPv_ = false;
+        }
+    }
+
+    MovePicker picker;
+    initMovePicker(picker, hashMove, ply);
+
+    int legalMoves = 0;
+    int originalAlpha = alpha;
+    uint32_t bestMove = 0;
+
+    // Quiets which failed to cut, their history is lowered on a cutoff
+    uint32_t quietsSearched[MAX_MOVES];
+    int quietsCount = 0;
+
+    while (uint32_t move = nextMove(picker)) {
+        if (!makeGeneratedMove(move)) {
+            continue;
+        }
+
+        playedMoves_[ply] = move;
+        (*ply_pointer)++;
+        legalMoves++;
+
+        // PVS: the first move is expected to be best, the others only
+        // have to be proven worse with a null window and are searched
+        // again in full when they are not
+        int score;
+        if (legalMoves == 1) {
+            score = -negamax_(-beta, -alpha, depth - 1, nullptr, ply_pointer);
+            followPv_ = false;
+        } else {
+            // Late quiet moves are searched shallower first, and at full
+            // depth only if they beat alpha anyway. The side to move is
+            // the opponent now, so a check means the move gives check.
+            int reduction = 0;
+            if (useLateMoveReductions && depth >= 3 && !inCheck &&
+                legalMoves > (isPvNode ? 4 : 2) && isQuietMove(move) &&
+                !isMyKingInCheck()) {
+                reduction = lateMoveReductionTable[std::min(
+                                depth, MAX_SEARCH_DEPTH)][legalMoves] -
+                            isPvNode;
+                reduction = std::clamp(reduction, 0, depth - 2);
+            }
+
+            score = -negamax_(-alpha - 1, -alpha, depth - 1 - reduction,
+                              nullptr, ply_pointer);
+            if (reduction) {
+                stats.lateMoveReductions++;
+                if (score > alpha) {
+                    stats.lateMoveResearches++;
+                    score = -negamax_(-alpha - 1, -alpha, depth - 1, nullptr,
+                                      ply_pointer);
+                }
+            }
+            if (score > alpha && score < beta) {
+                score = -negamax_(-beta, -alpha, depth - 1, nullptr,
+                                  ply_pointer);
+            }
+        }
+        undoMove();
+        (*ply_pointer)--;
+
+        // The score of an aborted subtree is meaningless, store nothing
+        if (isStopped()) {
+            return 0;
+        }
+
+        if (score >= beta) {
+            stats.betaCutoffs++;
+            stats.firstMoveCutoffs += legalMoves == 1;
+
+            if (isQuietMove(move)) {
+                int bonus = std::min(depth * depth, 400);
+                storeKiller(move, *ply_pointer);
+                updateHistory(move, bonus);
+                for (int index = 0; index < quietsCount; index++) {
+                    updateHistory(quietsSearched[index], -bonus);
+                }
+            }
+            if (transpositionTable) {
+                transpositionTable->store(
+                    key, move, scoreToTranspositionTable(beta, *ply_pointer),
+                    depth, BOUND_LOWER);
+            }
+            return beta;
+        }
+        if (score > alpha) {
+            alpha = score;
+            bestMove = move;
+            if (outBestMove_pointer) {
+                *outBestMove_pointer = move;
+            }
+
+            // Triangular PV table: this move followed by the child line
+            pvTable_[ply][ply] = move;
+            for (int next = ply + 1; next < pvLength_[ply + 1]; next++) {
+                pvTable_[ply][next] = pvTable_[ply + 1][next];
+            }
+            pvLength_[ply] = pvLength_[ply + 1];
+        }
+        if (isQuietMove(move)) {
+            quietsSearched[quietsCount++] = move;
+        }
+    }
+
+    if (!legalMoves) {
+        if (inCheck) {
+            return -MATE_SCORE + (*ply_pointer);
+        } else {
+            return 0;
+        }
+    }
+
+    if (transpositionTable) {
+        transpositionTable->store(
+            key, bestMove, scoreToTranspositionTable(alpha, *ply_pointer),
+            depth, alpha > originalAlpha ? BOUND_EXACT : BOUND_UPPER);
+    }
 
     return alpha;
 }
 
+// A capture must be able to lift the score this close to alpha
+const int DELTA_MARGIN = 200;
+
+int Engine::quiescence_(int alpha, int beta, int ply) {
+    countNode_();
+    qnodes++;
+    if (isStopped()) {
+        return 0;
+    }
+    if (ply >= MAX_PLY) {
+        return evaluatePosition();
+    }
+
+    // Captures are not part of the PV
+    pvLength_[ply] = ply;
+    seldepth_ = std::max(seldepth_, ply);
+
+    // Check evasions are searched in full, standing pat is not an option
+    bool inCheck = isMyKingInCheck();
+    int standPat = 0;
+
+    if (!inCheck) {
+        standPat = evaluatePosition();
+        if (standPat >= beta) {
+            return beta;
+        }
+
+        // Not even taking a queen while promoting would reach alpha
+        if (standPat + materialScores[QUEEN] * 2 + DELTA_MARGIN < alpha) {
+            return alpha;
+        }
+        alpha = std::max(alpha, standPat);
+    }
+
+    MovePicker picker;
+    initMovePicker(picker, 0, ply, !inCheck);
+    int legalMoves = 0;
+
+    while (uint32_t move = nextMove(picker)) {
+        Square to = static_cast<Square>((move >> 6) & 0x3f);
+        Piece promoted = static_cast<Piece>((move >> 16) & 0xf);
+
+        if (!inCheck && promoted == EMPTY) {
+            PieceBoard victim = board.status.mailbox[to];
+            int gain = victim == NO_PIECE ? materialScores[PAWN]
+                                          : materialScores[victim / 2];
+            if (standPat + gain + DELTA_MARGIN < alpha) {
+                continue;
+            }
+        }
+
+        if (!makeGeneratedMove(move)) {
+            continue;
+        }
+        legalMoves++;
+        int score = -quiescence_(-beta, -alpha, ply + 1);
+        undoMove();
+
+        if (isStopped()) {
+            return 0;
+        }
+        if (score >= beta) {
+            return beta;
+        }
+        alpha = std::max(alpha, score);
+    }
+
+    if (inCheck && !legalMoves) {
+        return -MATE_SCORE + ply;
+    }
+    return alpha;
+}
+
 std::pair<Move, int> Engine::negamax(int depth) {
-    int alpha = -50000;
+    int alpha = -INFINITE_SCORE;
     int beta = -alpha;
     uint32_t bestMove = 0;
     int ply = 0;
 
     int score = negamax_(alpha, beta, depth, &bestMove, &ply);
-    assert(bestMove);
     return {Move(bestMove), score};
 }
 
-std::pair<Move, int> Engine::searchBestMove(int depth) {
-    return negamax(depth);
+bool Engine::isStopped() const {
+    return canStop_ && signals->stop.load(std::memory_order_relaxed);
 }
 
-int Engine::evaluatePosition() {
-    // PST lookup indexed by PieceBoard (0=WHITE_PAWNS .. 11=BLACK_KING)
-    static const int* middleGamePst[12] = {
-        pstPawnMg,   pstPawnMg,   pstRookMg,   pstRookMg,
-        pstKnightMg, pstKnightMg, pstBishopMg, pstBishopMg,
-        pstQueenMg,  pstQueenMg,  pstKingMg,   pstKingMg,
-    };
-    static const int* endGamePst[12] = {
-        pstPawnEg,   pstPawnEg,   pstRookEg,   pstRookEg,
-        pstKnightEg, pstKnightEg, pstBishopEg, pstBishopEg,
-        pstQueenEg,  pstQueenEg,  pstKingEg,   pstKingEg,
-    };
+bool Engine::isPondering_() {
+    if (pondering_ && !signals->ponder.load(std::memory_order_relaxed)) {
+        // ponderhit: the predicted move was played, our clock runs now
+        pondering_ = false;
+        timeManager.restart();
+    }
+    return pondering_;
+}
 
-    // Phase increment per piece (P=0, R=2, N=1, B=1, Q=4, K=0)
-    static const int pieceBoosts[12] = {0, 0, 2, 2, 1, 1, 1, 1, 4, 4, 0, 0};
+std::pair<Move, int> Engine::search(const SearchLimits& limits) {
+    signals->nodes = 0;
+    signals->qnodes = 0;
+    if (transpositionTable) {
+        transpositionTable->newSearch();
+    }
+    ageHistory();
 
-    int mgScore = 0;
-    int egScore = 0;
-    int pieceBoost = 0;
+    // Lazy SMP: helpers search the same position on their own copy of the
+    // engine and only help by filling the shared transposition table
+    std::vector<Engine> helpers;
+    std::vector<std::thread> helperThreads;
+    if (threadsCount > 1) {
+        SearchLimits helperLimits = limits;
+        helperLimits.infinite = true;  // the main thread owns the clock
+        helperLimits.ponder = false;
 
-    for (int bbIndex = 0; bbIndex < 12; bbIndex++) {
-        Bitboard bitboard = board.status.boards[bbIndex];
-        auto ps = pieceBoardToSideColorMap.at(static_cast<PieceBoard>(bbIndex));
-        Color side = ps.first;
-        Piece piece = ps.second;
+        helpers.reserve(threadsCount - 1);
+        for (int index = 1; index < threadsCount; index++) {
+            helpers.push_back(*this);
+            helpers.back().threadsCount = 1;
+            helpers.back().printSearchInfo = false;
+        }
+        for (int index = 1; index < threadsCount; index++) {
+            Engine* helper = &helpers[index - 1];
+            helperThreads.emplace_back([helper, helperLimits, index]() {
+                helper->iterativeDeepening_(helperLimits, index);
+            });
+        }
+    }
 
-        int material = materialScoreMap.at(piece);
-        int sign = (side == WHITE) ? 1 : -1;
+    auto result = iterativeDeepening_(limits, 0);
 
-        while (!bitboard.isEmpty()) {
-            int popedSquare = bitboard.leastSignificantBeatIndex();
-            int squarePosition =
-                (side == WHITE) ? popedSquare : (popedSquare ^ 56);
+    // bestmove must wait for stop (infinite) or stop/ponderhit (ponder)
+    while (!signals->stop && (limits.infinite || signals->ponder)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
 
-            mgScore +=
-                sign * (material + middleGamePst[bbIndex][squarePosition]);
-            egScore += sign * (material + endGamePst[bbIndex][squarePosition]);
-            pieceBoost += pieceBoosts[bbIndex];
+    if (!helperThreads.empty()) {
+        signals->stop = true;
+        for (std::thread& helperThread : helperThreads) {
+            helperThread.join();
+        }
+    }
+
+    return result;
+}
 
-            bitboard.clearBit(popedSquare);
+// Mate scores are reported in moves, negative when getting mated
+std::string scoreToUCI(int score) {
+    if (score > MATE_BOUND) {
+        return "mate " + std::to_string((MATE_SCORE - score + 1) / 2);
+    }
+    if (score < -MATE_BOUND) {
+        return "mate " + std::to_string(-(MATE_SCORE + score) / 2);
+    }
+    return "cp " + std::to_string(score);
+}
+
+std::vector<Move> Engine::principalVariation() const {
+    return std::vector<Move>(previousPv_, previousPv_ + previousPvLength_);
+}
+
+uint64_t Engine::searchedNodes_() const {
+    // Nodes are published in batches, add the part not published yet
+    return signals->nodes.load(std::memory_order_relaxed) +
+           nodes % TIME_CHECK_NODES;
+}
+
+uint64_t Engine::searchedQnodes_() const {
+    return signals->qnodes.load(std::memory_order_relaxed) + qnodes -
+           publishedQnodes_;
+}
+
+std::pair<Move, int> Engine::iterativeDeepening_(const SearchLimits& limits,
+                                                 int threadIndex) {
+    timeManager.start(limits, board.status.side.value());
+    nodes = 0;
+    qnodes = 0;
+    publishedQnodes_ = 0;
+    stats = SearchStats();
+    pondering_ = limits.ponder;
+    std::fill(&killers[0][0], &killers[0][0] + MAX_SEARCH_DEPTH * 2, 0);
+
+    // Helpers may stop at any time, and half of them skip depth one so the
+    // threads do not all search the same depth at once
+    canStop_ = threadIndex > 0;
+    int startDepth = 1 + threadIndex % 2;
+
+    int maxDepth = limits.depth > 0 ? std::min(limits.depth, MAX_SEARCH_DEPTH)
+                                    : MAX_SEARCH_DEPTH;
+    uint32_t bestMove = 0;
+    int bestScore = 0;
+
+    previousPvLength_ = 0;
+
+    for (int depth = startDepth; depth <= maxDepth; depth++) {
+        uint32_t move = 0;
+        int ply = 0;
+        followPv_ = true;
+        seldepth_ = 0;
+        int score =
+            negamax_(-INFINITE_SCORE, INFINITE_SCORE, depth, &move, &ply);
+
+        // Keep the move of the last completed iteration
+        if (isStopped()) {
+            break;
+        }
+        bestMove = move;
+        bestScore = score;
+        previousPvLength_ = pvLength_[0];
+        std::copy(pvTable_[0], pvTable_[0] + pvLength_[0], previousPv_);
+
+        if (printSearchInfo && bestMove) {
+            int64_t elapsed = timeManager.elapsed();
+            uint64_t totalNodes = searchedNodes_();
+            std::ostringstream info;
+            info << "info depth " << depth << " seldepth " << seldepth_
+                 << " score " << scoreToUCI(bestScore) << " nodes "
+                 << totalNodes << " nps "
+                 << totalNodes * 1000 / std::max<int64_t>(elapsed, 1)
+                 << " time " << elapsed << " pv";
+            for (int index = 0; index < previousPvLength_; index++) {
+                info << " " << Move(previousPv_[index]).toStringUCI();
+            }
+            sendUCI(info.str());
+            sendUCI("info string qnodes " + std::to_string(searchedQnodes_()));
+        }
+
+        // Depth one always completes so there is a move to play
+        canStop_ = true;
+
+        // No legal move, nothing deeper to find
+        if (!bestMove ||
+            (!isPondering_() && timeManager.softLimitReached())) {
+            break;
         }
     }
 
-    pieceBoost = std::min(pieceBoost, 24);
-    int result = ((mgScore * pieceBoost) + (egScore * (24 - pieceBoost))) / 24;
+    signals->nodes.fetch_add(nodes % TIME_CHECK_NODES,
+                             std::memory_order_relaxed);
+    signals->qnodes.fetch_add(qnodes - publishedQnodes_,
+                              std::memory_order_relaxed);
+    publishedQnodes_ = qnodes;
+
+    // Main thread counters only, for tuning
+    if (printSearchInfo) {
+        std::ostringstream info;
+        info.precision(1);
+        info << std::fixed << "info string cutoffs " << stats.betaCutoffs
+             << " firstmove " << stats.firstMoveCutoffRate() * 100
+             << "% nullmove cutoffs " << stats.nullMoveCutoffs << "/"
+             << stats.nullMoveTries << " lmr researches "
+             << stats.lateMoveResearches << "/" << stats.lateMoveReductions;
+        sendUCI(info.str());
+    }
+    return {Move(bestMove), bestScore};
+}
+
+std::pair<Move, int> Engine::searchBestMove(int depth) {
+    SearchLimits limits;
+    limits.depth = depth;
+    signals->stop = false;
+    signals->ponder = false;
+    return search(limits);
+}
+
+// Tapered blend of the scores kept by make and undo, the phase drops from
+// MAX_GAME_PHASE towards the endgame as pieces leave the board
+int Engine::evaluatePosition() {
+    const EvaluationScores& scores = board.status.scores;
+    int phase = std::min(scores.phase, MAX_GAME_PHASE);
+    int result = (scores.middleGame * phase +
+                  scores.endGame * (MAX_GAME_PHASE - phase)) /
+                 MAX_GAME_PHASE;
 
     // return final evaluation based on side
     return (board.status.side.value() == WHITE) ? result : -result;
@@ -1121,17 +1637,10 @@ int Engine::evaluateMaterialScore() {
     int score = 0;
 
     for (int bbIndex = 0; bbIndex < 12; bbIndex++) {
-        Bitboard bitboard = board.status.boards[bbIndex];
-        while (!bitboard.isEmpty()) {
-            auto ps =
-                pieceBoardToSideColorMap.at(static_cast<PieceBoard>(bbIndex));
-            Color side = ps.first;
-            Piece piece = ps.second;
-            int pieceScore = materialScoreMap.at(piece);
-            score += (side == WHITE) ? +pieceScore : -pieceScore;
-
-            bitboard.clearBit(bitboard.leastSignificantBeatIndex());
-        }
+        auto [side, piece] = pieceBoardToSideColor[bbIndex];
+        int pieceScore = materialScores[piece] *
+                         board.status.boards[bbIndex].popCount();
+        score += (side == WHITE) ? +pieceScore : -pieceScore;
     }
     return score;
 }
@@ -1140,7 +1649,7 @@ int Engine::evaluateMaterialScore() {
 
 #pragma region UCI
 
-bool Engine::parseUCIGo(std::string input) {
+bool Engine::parseUCIGoLimits(std::string input, SearchLimits& limits) {
     std::istringstream iss(input);
     std::string token;
 
@@ -1150,25 +1659,117 @@ bool Engine::parseUCIGo(std::string input) {
         return false;
     }
 
-    iss >> token;
+    limits = SearchLimits();
+    while (iss >> token) {
+        if (token == "depth") {
+            iss >> limits.depth;
+        } else if (token == "wtime") {
+            iss >> limits.wtime;
+        } else if (token == "btime") {
+            iss >> limits.btime;
+        } else if (token == "winc") {
+            iss >> limits.winc;
+        } else if (token == "binc") {
+            iss >> limits.binc;
+        } else if (token == "movestogo") {
+            iss >> limits.movestogo;
+        } else if (token == "movetime") {
+            iss >> limits.movetime;
+        } else if (token == "infinite") {
+            limits.infinite = true;
+        } else if (token == "ponder") {
+            limits.ponder = true;
+        }
+    }
 
-    int depth;
-    if (token == "depth") {
-        iss >> depth;
-        logger.debug("Using depth = " + std::to_string(depth));
-    } else {
+    bool hasClock = limits.movetime >= 0 || limits.wtime >= 0 ||
+                    limits.btime >= 0 || limits.infinite;
+    if (limits.depth <= 0 && !hasClock) {
         logger.debug("Using default depth = 6");
-        depth = 6;
+        limits.depth = 6;
+    }
+
+    return true;
+}
+
+bool Engine::parseUCIGo(std::string input) {
+    SearchLimits limits;
+    if (!parseUCIGoLimits(input, limits)) {
+        return false;
     }
 
-    auto searchResult = searchBestMove(depth);
-    Move bestMove = searchResult.first;
-    int score = searchResult.second;
-    std::cout << "info score cp " << score << " depth " << depth << std::endl;
-    std::cout << "bestmove " << bestMove.toStringUCI() << std::endl;
+    signals->stop = false;
+    signals->ponder = limits.ponder;
+    searchAndReport(limits);
     return true;
 }
 
+void Engine::searchAndReport(const SearchLimits& limits) {
+    auto searchResult = search(limits);
+    sendUCI("bestmove " + searchResult.first.toStringUCI());
+}
+
+bool Engine::parseUCISetOption(std::string input) {
+    std::istringstream iss(input);
+    std::string token;
+
+    iss >> token;
+    if (token != "setoption") {
+        logger.error("No setoption command found: " + token);
+        return false;
+    }
+
+    std::string name;
+    std::string value;
+    iss >> token;
+    if (token != "name") {
+        logger.error("'setoption' command with wrong format");
+        return false;
+    }
+
+    while (iss >> token && token != "value") {
+        name += (name.empty() ? "" : " ") + token;
+    }
+    iss >> value;
+
+    if (name == "Hash") {
+        int megabytes = std::atoi(value.c_str());
+        if (megabytes < 1) {
+            logger.error("Wrong Hash value: " + value);
+            return false;
+        }
+        transpositionTable->resize(megabytes);
+        logger.debug("Hash set to " + value + " MB");
+        return true;
+    }
+
+    if (name == "Threads") {
+        int threads = std::atoi(value.c_str());
+        if (threads < 1 || threads > MAX_THREADS) {
+            logger.error("Wrong Threads value: " + value);
+            return false;
+        }
+        threadsCount = threads;
+        logger.debug("Threads set to " + value);
+        return true;
+    }
+
+    if (name == "NullMove" || name == "LMR") {
+        if (value != "true" && value != "false") {
+            logger.error("Wrong " + name + " value: " + value);
+            return false;
+        }
+        bool& option =
+            name == "NullMove" ? useNullMovePruning : useLateMoveReductions;
+        option = value == "true";
+        logger.debug(name + " set to " + value);
+        return true;
+    }
+
+    logger.warn("Unknown option: " + name);
+    return false;
+}
+
 bool Engine::parseUCIPosition(std::string input) {
     std::istringstream iss(input);
     std::string token;
@@ -1238,35 +1839,69 @@ bool Engine::parseUCIMove(std::string move) {
 bool Engine::UCIok() {
     std::cout << "id name Khez" << std::endl;
     std::cout << "id author Javello" << std::endl;
+    std::cout << "option name Hash type spin default " << DEFAULT_HASH_MB
+              << " min 1 max 65536" << std::endl;
+    std::cout << "option name Threads type spin default 1 min 1 max "
+              << MAX_THREADS << std::endl;
+    std::cout << "option name NullMove type check default true" << std::endl;
+    std::cout << "option name LMR type check default true" << std::endl;
     std::cout << "uciok" << std::endl;
     return false;
 }
 
 void Engine::UCI() {
+    printSearchInfo = true;
     UCIok();
 
-    while (true) {
-        std::string input;
-        getline(std::cin, input);
+    // The search runs on its own thread so this one can keep reading
+    // commands, like isready and stop, while it thinks
+    std::thread searchThread;
+    auto stopSearch = [&]() {
+        signals->stop = true;
+        if (searchThread.joinable()) {
+            searchThread.join();
+        }
+    };
 
+    std::string input;
+    while (getline(std::cin, input)) {
         std::string command = input.substr(0, input.find(' '));
         if (command == "isready") {
-            std::cout << "readyok" << std::endl;
+            sendUCI("readyok");
         } else if (command == "position") {
+            stopSearch();
             parseUCIPosition(input);
             logger.info(board.toStringComplete());
+        } else if (command == "setoption") {
+            stopSearch();
+            parseUCISetOption(input);
         } else if (command == "ucinewgame") {
+            stopSearch();
+            transpositionTable->clear();
+            std::fill(&history[0][0][0], &history[0][0][0] + 2 * 64 * 64, 0);
             parseUCIPosition("position startpos");
             logger.info(board.toStringComplete());
         } else if (command == "go") {
-            parseUCIGo(input);
-            logger.info(board.toStringComplete());
+            stopSearch();
+            SearchLimits limits;
+            if (parseUCIGoLimits(input, limits)) {
+                signals->stop = false;
+                signals->ponder = limits.ponder;
+                searchThread =
+                    std::thread([this, limits]() { searchAndReport(limits); });
+            }
+        } else if (command == "stop") {
+            stopSearch();
+        } else if (command == "ponderhit") {
+            signals->ponder = false;
         } else if (command == "uci") {
             UCIok();
         } else if (command == "quit") {
             break;
         }
     }
+
+    stopSearch();
 }
 
 #pragma endregion
@@ -1274,47 +1909,160 @@ void Engine::UCI() {
 #pragma region PerfT
 
 long long int Engine::perftDriver(const int depth) {
+    if (verifyHashKeys && board.status.hashKey != board.computeHashKey()) {
+        hashKeyMismatches++;
+    }
+
     if (depth == 0) {
         return 1;
     }
 
-    std::vector<u_int32_t> moves = generateAllPseudoLegalMoves();
     long long int nodes = 0;
+    if (perftTable && perftTable->probe(board.status.hashKey, depth, nodes)) {
+        return nodes;
+    }
+
+    MoveList moves = generateMoves();
+
+    // Legal moves are leaves already, unless their hash keys are verified
+    if (depth == 1 && generationMode == GENERATE_LEGAL && !verifyHashKeys) {
+        return moves.size();
+    }
 
     for (const auto& move : moves) {
-        if (makeMove(move)) {
+        if (makeGeneratedMove(move)) {
             nodes += perftDriver(depth - 1);
             board.undoLastMove();
         }
     }
+
+    if (perftTable) {
+        perftTable->store(board.status.hashKey, depth, nodes);
+    }
     return nodes;
 }
 
-void Engine::perfTest(const int depth) {
-    auto startTime = std::chrono::high_resolution_clock::now();
+void Engine::collectPerftTasks_(int plies, int depth, size_t rootIndex,
+                                std::vector<PerftTask>& tasks) {
+    if (plies == 0 || depth == 0) {
+        tasks.push_back(PerftTask{rootIndex, board.status, depth});
+        return;
+    }
 
-    std::vector<Move> rootMoves = generateAllPseudoLegalMovesAsMoveList();
+    // Split nodes are checked by the task running perftDriver on them
+    if (verifyHashKeys && board.status.hashKey != board.computeHashKey()) {
+        hashKeyMismatches++;
+    }
 
-    long long int totalNodes = 0;
+    MoveList moves = generateMoves();
+    for (const auto& move : moves) {
+        if (makeGeneratedMove(move)) {
+            collectPerftTasks_(plies - 1, depth - 1, rootIndex, tasks);
+            board.undoLastMove();
+        }
+    }
+}
+
+std::vector<std::pair<Move, long long int>> Engine::perftDivide(
+    const int depth) {
+    std::vector<std::pair<Move, long long int>> divide;
+    MoveList rootMoves = generateMoves();
+
+    if (perftThreads <= 1 || depth <= 1) {
+        for (auto move : rootMoves) {
+            if (makeGeneratedMove(move)) {
+                divide.push_back({Move(move), perftDriver(depth - 1)});
+                board.undoLastMove();
+            }
+        }
+        return divide;
+    }
+
+    std::vector<PerftTask> tasks;
+    int splitDepth = std::clamp(perftSplitDepth, 1, depth);
     for (auto move : rootMoves) {
-        if (makeMove(move)) {
-            long long int moveCount = perftDriver(depth - 1);
-            Move m(move);
-            logger.debug(m.toString() + ": " + std::to_string(moveCount));
-            totalNodes += moveCount;
+        if (makeGeneratedMove(move)) {
+            divide.push_back({Move(move), 0});
+            collectPerftTasks_(splitDepth - 1, depth - 1, divide.size() - 1,
+                               tasks);
             board.undoLastMove();
         }
     }
 
+    ThreadPool pool(perftThreads);
+    std::vector<Engine> workers(pool.size(), *this);
+    for (Engine& worker : workers) {
+        worker.hashKeyMismatches = 0;
+    }
+
+    // Every task owns its slot, results are summed in root move order so
+    // the divide does not depend on scheduling
+    std::vector<long long int> counts(tasks.size());
+    for (size_t index = 0; index < tasks.size(); index++) {
+        pool.enqueue([&, index](size_t workerIndex) {
+            Engine& worker = workers[workerIndex];
+            worker.board.status = tasks[index].status;
+            counts[index] = worker.perftDriver(tasks[index].depth);
+        });
+    }
+    pool.wait();
+
+    for (size_t index = 0; index < tasks.size(); index++) {
+        divide[tasks[index].rootIndex].second += counts[index];
+    }
+    for (const Engine& worker : workers) {
+        hashKeyMismatches += worker.hashKeyMismatches;
+    }
+
+    return divide;
+}
+
+void Engine::perfTest(const int depth) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    hashKeyMismatches = 0;
+
+    auto divide = perftDivide(depth);
+
+    long long int totalNodes = 0;
+    for (const auto& [move, moveCount] : divide) {
+        logger.debug(move.toString() + ": " + std::to_string(moveCount));
+        totalNodes += moveCount;
+    }
+
     auto endTime = std::chrono::high_resolution_clock::now();
+    long long int elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(endTime -
+                                                              startTime)
+            .count();
+
+    std::ostringstream mnps;
+    mnps.precision(2);
+    mnps << std::fixed
+         << (double)totalNodes / std::max<long long int>(elapsed, 1) / 1000;
 
     logger.info(
-        "\n\t\tDepth: " + std::to_string(depth) + "\n" +
-        "\t\tTotal nodes: " + std::to_string(totalNodes) + "\n" + "\t\tTime: " +
-        std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
-                           endTime - startTime)
-                           .count()) +
-        "ms" + "\n");
+        "\n\t\tDepth: " + std::to_string(depth) + "\n" + "\t\tThreads: " +
+        std::to_string(perftThreads) + " (split depth " +
+        std::to_string(perftSplitDepth) + ")\n" + "\t\tHash: " +
+        (perftTable ? std::to_string(perftTable->entriesCount()) + " entries"
+                    : "off") +
+        "\n" + "\t\tMove generation: " +
+        (generationMode == GENERATE_LEGAL ? "legal" : "pseudo-legal") + "\n" +
+        "\t\tUndo mode: " +
+        (board.undoMode == UNDO_SNAPSHOT ? "snapshot" : "incremental") + "\n" +
+        "\t\tTotal nodes: " + std::to_string(totalNodes) + "\n" +
+        "\t\tTime: " + std::to_string(elapsed) + "ms" + "\n" +
+        "\t\tMnps: " + mnps.str() + "\n");
+
+    if (verifyHashKeys) {
+        std::string message = "Hash key mismatches: " +
+                              std::to_string(hashKeyMismatches);
+        if (hashKeyMismatches) {
+            logger.error(message);
+        } else {
+            logger.info(message);
+        }
+    }
 }
 
 #pragma endregion
\ No newline at end of file
@@ -1,73 +1,191 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "../bitboard/bitboard.h"
+#include "./attacks/attacks.h"
 #include "./chessboard/chessboard-status.h"
 #include "./chessboard/chessboard.h"
 #include "./chessboard/color.h"
 #include "./chessboard/piece.h"
-#include "./chessboard/sliding-piece.h"
 #include "./chessboard/square.h"
+#include "./move/move-list.h"
 #include "./move/move.h"
+#include "./perft/perft-table.h"
+#include "./search/search-signals.h"
+#include "./search/search-stats.h"
+#include "./search/time-manager.h"
+#include "./search/transposition-table.h"
+
+enum MoveGenerationMode {
+    GENERATE_LEGAL,         // Pins and check masks, every move is legal
+    GENERATE_PSEUDO_LEGAL,  // makeMove rejects moves leaving the king in check
+};
+
+// Move subsets, search generates captures and quiets in separate stages
+enum GeneratedMoves {
+    ALL_MOVES,
+    CAPTURE_MOVES,  // Captures, en passant and every promotion
+    QUIET_MOVES,    // Everything else, castling included
+};
 
 class Engine {
    public:
     ChessBoard board;
 
+    // Shared with every engine searching the same game
+    std::shared_ptr<TranspositionTable> transpositionTable;
+
     void init();
 
     void emptyBoard();
     void setupInitialPosition();
     void parseFEN(const std::string FEN);
 
-    Bitboard setOccupancy(int index, Bitboard attacksMask);
-
-    // Masks
-
-    Bitboard generateSinglePawnMaskAttacks(Square square, Color color);
-    Bitboard getSinglePawnAttacks(Square square, Color color);
+    // Attacks, looked up in the process wide tables
+
+    Bitboard getSinglePawnAttacks(Square square, Color color) {
+        return attacks_->pawnAttacksMasks[color][square];
+    }
+    Bitboard getSingleKnightAttacks(Square square) {
+        return attacks_->knightAttacksMasks[square];
+    }
+    Bitboard getSingleKingAttacks(Square square) {
+        return attacks_->kingAttacksMasks[square];
+    }
+    Bitboard getSingleBishopAttacks(Square square, Bitboard occupancies) {
+        return bishopAttacks(*attacks_, square, occupancies);
+    }
+    Bitboard getSingleRookAttacks(Square square, Bitboard occupancies) {
+        return rookAttacks(*attacks_, square, occupancies);
+    }
+    Bitboard getSingleQueenAttacks(Square square, Bitboard occupancies) {
+        return getSingleBishopAttacks(square, occupancies) |
+               getSingleRookAttacks(square, occupancies);
+    }
 
-    Bitboard generateSingleKnightAttacksMask(Square square);
-    Bitboard getSingleKnightAttacks(Square square);
-
-    Bitboard generateSingleKingAttacksMask(Square square);
-    Bitboard getSingleKingAttacks(Square square);
-
-    Bitboard generateSingleBishopRelevantOccupanciesMask(Square square);
-    Bitboard generateSingleBishopAttacks(Square square, Bitboard blocks);
-    Bitboard getSingleBishopAttacks(Square square, Bitboard occupancies);
-
-    Bitboard generateSingleRookRelevantOccupanciesMask(Square square);
-    Bitboard generateSingleRookAttacks(Square square, Bitboard blocks);
-    Bitboard getSingleRookAttacks(Square square, Bitboard occupancies);
+    // Move generation
 
-    Bitboard getSingleQueenAttacks(Square square, Bitboard occupancies);
+    // Generator used by search and perft, the other one is kept as reference
+    MoveGenerationMode generationMode = GENERATE_LEGAL;
 
-    void generateSliderPiecesAttacks(SlidingPiece piece);
+    MoveList generateMoves();
+    bool makeGeneratedMove(u_int32_t move);
 
-    // Move generation
+    MoveList generateLegalMoves(GeneratedMoves type = ALL_MOVES);
+    MoveList generateAllPseudoLegalMoves(GeneratedMoves type = ALL_MOVES);
 
-    std::vector<u_int32_t> generateAllPseudoLegalMoves();
+    // Set-wise pawn generation used by every generator, the per-square one
+    // is kept as reference for tests and benchmarks
+    void generatePawnMoves(MoveList& moves, GeneratedMoves type = ALL_MOVES);
+    void generatePawnMovesPerSquare(MoveList& moves);
     std::vector<Move> generateAllPseudoLegalMovesAsMoveList();
     void __printMoves(std::vector<Move> moves);
 
     bool makeMove(Move move);
+    bool makeMove(u_int32_t move);
     void undoMove();
 
     bool isSquareUnderAttackBy(Square square, Color color);
     void __printAttackedSquare(Color color);
 
+    struct LegalityMasks {
+        Square king;
+        Bitboard checkers;
+        Bitboard checkMask;  // Capture the checker or block, all if no check
+        Bitboard pinned;
+    };
+
+    // Move ordering
+
+    enum PickerStage {
+        STAGE_HASH_MOVE,
+        STAGE_GENERATE_CAPTURES,
+        STAGE_GOOD_CAPTURES,
+        STAGE_KILLERS,
+        STAGE_GENERATE_QUIETS,
+        STAGE_QUIETS,
+        STAGE_BAD_CAPTURES,
+        STAGE_DONE,
+    };
+
+    // Yields the hash move, captures by MVV-LVA, the killers, the other
+    // quiets and last the captures losing material by SEE, generating a
+    // stage only once the previous one is exhausted so a early cutoff never
+    // pays for the quiet moves
+    struct MovePicker {
+        PickerStage stage;
+        uint32_t hashMove;
+        uint32_t killers[2];  // Zeroed when not playable here
+        int killerIndex;  // Next killer to try
+        bool capturesOnly;  // Quiescence stops after the winning captures
+        LegalityMasks masks;  // Only used by the legal generator
+        MoveList moves;
+        size_t index;  // Next move to pick, up to end
+        size_t end;
+        size_t badCaptures;  // Losing captures are moved to the front
+        size_t quiets;  // First quiet move, after every capture
+    };
+
+    // Two quiet moves per ply which recently caused a beta cutoff
+    uint32_t killers[MAX_SEARCH_DEPTH][2] = {};
+
+    // Butterfly history of quiet moves by side, from and to square. Raised
+    // on a beta cutoff, lowered for the quiets searched before the cutoff.
+    int history[2][64][64] = {};
+
+    void initMovePicker(MovePicker& picker, uint32_t hashMove, int ply,
+                        bool capturesOnly = false);
+    uint32_t nextMove(MovePicker& picker);  // 0 once every move was yielded
+    void storeKiller(uint32_t move, int ply);
+    void updateHistory(uint32_t move, int bonus);
+    void ageHistory();
+
+    // Static exchange evaluation, true if the move wins at least threshold
+    // once every recapture on its target square is played out
+    bool see(u_int32_t move, int threshold = 0);
+
     // Move search
+
+    TimeManager timeManager;
+    uint64_t nodes = 0;
+    uint64_t qnodes = 0;  // Quiescence nodes, also counted in nodes
+    SearchStats stats;
+
+    // Shared with the UCI input thread, which raises stop and ponderhit
+    std::shared_ptr<SearchSignals> signals = std::make_shared<SearchSignals>();
+
+    // Print UCI info lines after every completed iteration
+    bool printSearchInfo = false;
+
+    // Search threads, the main one plus threadsCount - 1 Lazy SMP helpers
+    int threadsCount = 1;
+
+    // Pruning and reductions, UCI options for A/B tests
+    bool useNullMovePruning = true;
+    bool useLateMoveReductions = true;
+
+    bool isStopped() const;
+
+    // Runs until a limit is reached or signals->stop is raised, the caller
+    // resets stop and ponder before starting
+    std::pair<Move, int> search(const SearchLimits& limits);
     std::pair<Move, int> negamax(int depth);
     std::pair<Move, int> searchBestMove(int depth);
+
+    // Line of the last completed iteration, starting with the best move
+    std::vector<Move> principalVariation() const;
     int evaluatePosition();
     int evaluateMaterialScore();
 
     // UCI
 
+    bool parseUCIGoLimits(std::string input, SearchLimits& limits);
     bool parseUCIGo(std::string input);
+    void searchAndReport(const SearchLimits& limits);
+    bool parseUCISetOption(std::string input);
     bool parseUCIPosition(std::string input);
     bool parseUCIMove(std::string input);
     bool UCIok();
@@ -75,50 +193,110 @@ class Engine {
 
     // perf tests
 
-    long long int perftDriver(const int depth);
-    void perfTest(const int depth);
-
-   private:
-    // Masks
-
-    Bitboard pawnAttacksMasks[2][64];
+    // Cross-check the incremental hash key against a full recompute at every
+    // perft node, counting failures in hashKeyMismatches
+    bool verifyHashKeys = false;
+    long long int hashKeyMismatches = 0;
 
-    Bitboard knightAttacksMasks[64];
+    // Parallel perft: the tree is cut perftSplitDepth plies below the root
+    // and every subtree becomes a task counted by a pool worker on its own
+    // engine copy. One thread keeps the serial recursion.
+    int perftThreads = 1;
+    int perftSplitDepth = 2;
 
-    Bitboard kingAttacksMasks[64];
+    // Optional subtree cache, shared with the parallel perft workers
+    std::shared_ptr<PerftTable> perftTable;
 
-    Bitboard bishopRelevantOccupanciesMasks[64];
-    Bitboard rookRelevantOccupanciesMasks[64];
-
-    Bitboard bishopAttacksTable[64][512];
-    Bitboard rookAttacksTable[64][4096];
+    long long int perftDriver(const int depth);
+    std::vector<std::pair<Move, long long int>> perftDivide(const int depth);
+    void perfTest(const int depth);
 
-    void generatePawnMaskAttacks();
-    void generateKnightMaskMoves();
-    void generateKingMaskMoves();
+   private:
+    // Read only, shared by every engine of the process
+    const AttackTables* attacks_ = &attackTables();
 
     // Move generation from status
 
-    void generatePawnMoves(std::vector<u_int32_t>& moves);
-    void generatePawnQuietMoves(Square from, std::vector<u_int32_t>& moves);
-    void generatePawnCaptureMoves(Square from, std::vector<u_int32_t>& moves);
+    void generatePseudoLegalMoves(MoveList& moves, GeneratedMoves type);
+
+    void generatePawnQuietMoves(Square from, MoveList& moves);
+    void generatePawnCaptureMoves(Square from, MoveList& moves);
 
-    void generateKingMoves(std::vector<u_int32_t>& moves);
-    void generateKingCastlingMoves(std::vector<u_int32_t>& moves);
+    void generateKingMoves(MoveList& moves, GeneratedMoves type);
+    void generateKingCastlingMoves(MoveList& moves);
     bool canWhiteCastleKingSide();
     bool canWhiteCastleQueenSide();
     bool canBlackCastleKingSide();
     bool canBlackCastleQueenSide();
 
-    void generateSliderAndLeaperMoves(Piece piece,
-                                      std::vector<u_int32_t>& moves);
+    void generateSliderAndLeaperMoves(Piece piece, MoveList& moves,
+                                      GeneratedMoves type = ALL_MOVES);
     Bitboard getAttacksBoard(Piece piece, Square square);
 
     bool isMyKingInCheck();
     bool isOpponentKingInCheck();
 
+    // Legal move generation
+
+    Bitboard attackersTo(Square square, Color color, Bitboard occupancies);
+    LegalityMasks computeLegalityMasks();
+    bool isLegal(u_int32_t move, const LegalityMasks& masks);
+    void generateLegalMoves(const LegalityMasks& masks, MoveList& moves,
+                            GeneratedMoves type);
+
+    // Move ordering
+
+    bool isPseudoLegal(u_int32_t move);
+    // Hash moves and killers, found in the table rather than generated
+    bool isPlayable(uint32_t move, const MovePicker& picker);
+    void generateStage(MovePicker& picker, GeneratedMoves type);
+    void scoreCaptures(MoveList& moves);
+    void scoreQuiets(MovePicker& picker);
+    uint32_t pickBestMove(MovePicker& picker);
+
+    // Perft
+
+    struct PerftTask {
+        size_t rootIndex;
+        ChessboardStatus status;
+        int depth;
+    };
+
+    void collectPerftTasks_(int plies, int depth, size_t rootIndex,
+                            std::vector<PerftTask>& tasks);
+
     // Search
 
+    // Depth one always completes, stops are honoured only afterwards
+    bool canStop_ = false;
+    bool pondering_ = false;
+
+    // Quiescence nodes already added to signals->qnodes
+    uint64_t publishedQnodes_ = 0;
+
+    // Triangular PV table, row ply holds the best line from ply onwards
+    uint32_t pvTable_[MAX_PLY + 1][MAX_PLY + 1];
+    int pvLength_[MAX_PLY + 1];
+    int seldepth_ = 0;
+
+    // PV of the last completed iteration, searched first by the next one
+    uint32_t previousPv_[MAX_PLY + 1];
+    int previousPvLength_ = 0;
+    bool followPv_ = false;
+
+    // Move played at every ply of the current line, 0 for a null move
+    uint32_t playedMoves_[MAX_PLY + 1];
+
+    bool isPondering_();
+    bool hasNonPawnMaterial_();
+    void countNode_();
+    uint64_t searchedNodes_() const;
+    uint64_t searchedQnodes_() const;
+
+    std::pair<Move, int> iterativeDeepening_(const SearchLimits& limits,
+                                             int threadIndex);
+
     int negamax_(int alpha, int beta, int depth, uint32_t* outBestMove,
                  int* ply);
+    int quiescence_(int alpha, int beta, int ply);
 };
@@ -36,6 +36,8 @@ const Bitboard notABFile = Bitboard(0x3f3f3f3f3f3f3f3f);
 const Bitboard notGHFile = Bitboard(0xfcfcfcfcfcfcfcfc);
 
 const Bitboard firstRank = Bitboard(0xFF00000000000000);
+const Bitboard thirdRank = Bitboard(0x0000FF0000000000);
+const Bitboard sixthRank = Bitboard(0x0000000000FF0000);
 const Bitboard eighthRank = Bitboard(0x00000000000000FF);
 
 /*
@@ -47,7 +49,7 @@ const Bitboard eighthRank = Bitboard(0x00000000000000FF);
         for (int file = 0; file < 8; file++) {
             int square = file + (8 * rank);
             rook_relevant_occupancies_counts[square] =
-                engine.generateSingleRookRelevantOccupanciesMask(square)
+                generateSingleRookRelevantOccupanciesMask(square)
                     .popCount();
         }
     }
@@ -127,11 +129,6 @@ const int castlingRights[64] = {
     15, 15, 15, 15, 15, 15, 15, 15, 7,  15, 15, 15, 3,  15, 15, 11,
 };
 
-const std::map<Piece, int> materialScoreMap = {
-    {PAWN, 100}, {KNIGHT, 300}, {BISHOP, 350},
-    {ROOK, 500}, {QUEEN, 1000}, {KING, 10000},
-};
-
 const int pstPawnMg[64] = {
     0,   0,   0,   0,   0,   0,  0,   0,   // a1 - h1
     -1,  -7,  -11, -35, -13, 5,  3,   -5,  //
@@ -263,3 +260,34 @@ const int pstKingEg[64] = {
     38,  41,  44,  45,  45,  44,  41,  38,   //
     42,  46,  48,  50,  50,  48,  46,  42,   //
 };
+
+// Defined after the piece-square tables it reads
+PieceSquareScores generatePieceSquareScores() {
+    // Indexed by PieceBoard, white and black share the tables
+    const int* middleGamePst[6] = {pstPawnMg,   pstRookMg,  pstKnightMg,
+                                   pstBishopMg, pstQueenMg, pstKingMg};
+    const int* endGamePst[6] = {pstPawnEg,   pstRookEg,  pstKnightEg,
+                                pstBishopEg, pstQueenEg, pstKingEg};
+    const int piecePhases[6] = {0, 2, 1, 1, 4, 0};
+
+    PieceSquareScores scores{};
+    for (int pieceBoard = 0; pieceBoard < 12; pieceBoard++) {
+        Piece piece = static_cast<Piece>(pieceBoard / 2);
+        bool isWhite = pieceBoard % 2 == 0;
+        int material = materialScores[piece];
+
+        for (int square = 0; square < 64; square++) {
+            // Black reads the tables mirrored vertically
+            int pstSquare = isWhite ? square : square ^ 56;
+            int sign = isWhite ? 1 : -1;
+            scores.middleGame[pieceBoard][square] =
+                sign * (material + middleGamePst[piece][pstSquare]);
+            scores.endGame[pieceBoard][square] =
+                sign * (material + endGamePst[piece][pstSquare]);
+        }
+        scores.phase[pieceBoard] = piecePhases[piece];
+    }
+    return scores;
+}
+
+const PieceSquareScores pieceSquareScores = generatePieceSquareScores();
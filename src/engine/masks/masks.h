@@ -1,7 +1,5 @@
 #pragma once
 
-#include <map>
-
 #include "../../bitboard/bitboard.h"
 #include "../chessboard/piece.h"
 
@@ -25,6 +23,8 @@ extern const Bitboard notABFile;
 extern const Bitboard notGHFile;
 
 extern const Bitboard firstRank;
+extern const Bitboard thirdRank;
+extern const Bitboard sixthRank;
 extern const Bitboard eighthRank;
 
 extern const int rookRelevantOccupanciesCounts[64];
@@ -35,7 +35,8 @@ extern const u_int64_t rookMagicNumbers[64];
 
 extern const int castlingRights[64];
 
-extern const std::map<Piece, int> materialScoreMap;
+// Indexed by Piece, the king outweighs any exchange
+constexpr int materialScores[7] = {100, 500, 300, 350, 1000, 10000, 0};
 
 extern const int pstPawnMg[64];
 extern const int pstPawnEg[64];
@@ -48,4 +49,17 @@ extern const int pstRookEg[64];
 extern const int pstQueenMg[64];
 extern const int pstQueenEg[64];
 extern const int pstKingMg[64];
-extern const int pstKingEg[64];
\ No newline at end of file
+extern const int pstKingEg[64];
+
+// Tapered evaluation terms by PieceBoard and square, from white's point of
+// view: material plus the piece-square bonus, and the phase weight of every
+// piece, MAX_GAME_PHASE being the opening
+struct PieceSquareScores {
+    int middleGame[12][64];
+    int endGame[12][64];
+    int phase[12];
+};
+
+const int MAX_GAME_PHASE = 24;
+
+extern const PieceSquareScores pieceSquareScores;
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// No legal chess position has more than 218 moves
+const size_t MAX_MOVES = 256;
+
+/*
+  Fixed capacity list of move binaries meant to live on the stack, so move
+  generation never touches the heap. Every move has a score slot used by
+  move ordering; swap keeps the move and its score together.
+*/
+class MoveList {
+   public:
+    void push_back(uint32_t move) {
+        assert(size_ < MAX_MOVES);
+        moves_[size_] = move;
+        scores_[size_] = 0;
+        size_++;
+    }
+
+    void clear() { size_ = 0; }
+
+    // Only shrinks, used to drop moves filtered out in place
+    void resize(size_t size) {
+        assert(size <= size_);
+        size_ = size;
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    uint32_t operator[](size_t index) const { return moves_[index]; }
+    uint32_t& operator[](size_t index) { return moves_[index]; }
+
+    int score(size_t index) const { return scores_[index]; }
+    void setScore(size_t index, int score) { scores_[index] = score; }
+
+    void swap(size_t first, size_t second) {
+        std::swap(moves_[first], moves_[second]);
+        std::swap(scores_[first], scores_[second]);
+    }
+
+    uint32_t* begin() { return moves_; }
+    uint32_t* end() { return moves_ + size_; }
+    const uint32_t* begin() const { return moves_; }
+    const uint32_t* end() const { return moves_ + size_; }
+
+   private:
+    uint32_t moves_[MAX_MOVES];
+    int scores_[MAX_MOVES];
+    size_t size_ = 0;
+};
@@ -3,47 +3,6 @@
 #include <bitset>
 #include <iomanip>
 
-const std::map<std::tuple<Piece, Piece, bool, bool, bool, bool>, MoveType>
-    moveTypeMap = {
-
-        {{KING, EMPTY, false, false, false, true},
-         CASTLE_KINGSIDE},  // only king because key would be the same
-
-        {{PAWN, EMPTY, false, false, false, false}, PAWN_PUSH},
-        {{PAWN, EMPTY, false, true, false, false}, PAWN_DOUBLE_PUSH},
-        {{PAWN, EMPTY, true, false, false, false}, PAWN_CAPTURE},
-        {{PAWN, EMPTY, true, false, true, false}, PAWN_CAPTURE_ENPASSANT},
-
-        {{PAWN, QUEEN, false, false, false, false}, PAWN_PROMOTION_TO_QUEEN},
-        {{PAWN, KNIGHT, false, false, false, false}, PAWN_PROMOTION_TO_KNIGHT},
-        {{PAWN, ROOK, false, false, false, false}, PAWN_PROMOTION_TO_ROOK},
-        {{PAWN, BISHOP, false, false, false, false}, PAWN_PROMOTION_TO_BISHOP},
-
-        {{PAWN, QUEEN, true, false, false, false},
-         PAWN_CAPTURE_PROMOTION_TO_QUEEN},
-        {{PAWN, KNIGHT, true, false, false, false},
-         PAWN_CAPTURE_PROMOTION_TO_KNIGHT},
-        {{PAWN, ROOK, true, false, false, false},
-         PAWN_CAPTURE_PROMOTION_TO_ROOK},
-        {{PAWN, BISHOP, true, false, false, false},
-         PAWN_CAPTURE_PROMOTION_TO_BISHOP},
-
-        {{KNIGHT, EMPTY, false, false, false, false}, KNIGHT_QUIET},
-        {{KNIGHT, EMPTY, true, false, false, false}, KNIGHT_CAPTURE},
-
-        {{BISHOP, EMPTY, false, false, false, false}, BISHOP_QUIET},
-        {{BISHOP, EMPTY, true, false, false, false}, BISHOP_CAPTURE},
-
-        {{ROOK, EMPTY, false, false, false, false}, ROOK_QUIET},
-        {{ROOK, EMPTY, true, false, false, false}, ROOK_CAPTURE},
-
-        {{QUEEN, EMPTY, false, false, false, false}, QUEEN_QUIET},
-        {{QUEEN, EMPTY, true, false, false, false}, QUEEN_CAPTURE},
-
-        {{KING, EMPTY, false, false, false, false}, KING_QUIET},
-        {{KING, EMPTY, true, false, false, false}, KING_CAPTURE},
-};
-
 std::map<MoveType, std::string> moveDescriptionMap = {
     {PAWN_PUSH, "PAWN_PUSH"},
     {PAWN_DOUBLE_PUSH, "PAWN_DOUBLE_PUSH"},
@@ -76,7 +35,8 @@ Move::Move(Square from, Square to, MoveType type) {
     *this = Move(createBinary(from, to, type));
 }
 
-u_int32_t Move::createBinary(Square from, Square to, MoveType type) {
+// Bits 12-23 of a move, piece, promoted piece and flags, for a MoveType
+constexpr u_int32_t moveTypeBits(MoveType type) {
     Piece piece = EMPTY;
     Piece promoted = EMPTY;
     bool isCapture = false;
@@ -175,9 +135,32 @@ u_int32_t Move::createBinary(Square from, Square to, MoveType type) {
             break;
     }
 
-    return (from) | (to << 6) | ((piece != EMPTY ? piece : 0) << 12) |
-           ((promoted != EMPTY ? promoted : EMPTY) << 16) | (isCapture << 20) |
-           (isDoublePush << 21) | (isEnpassant << 22) | (isCastling << 23);
+    return (piece << 0) | (promoted << 4) | (isCapture << 8) |
+           (isDoublePush << 9) | (isEnpassant << 10) | (isCastling << 11);
+}
+
+const int MOVE_TYPES_COUNT = KING_CAPTURE + 1;
+
+struct MoveTypeTables {
+    u_int32_t bits[MOVE_TYPES_COUNT];
+    uint8_t types[1 << 12];  // MoveType by bits 12-23, PAWN_PUSH if unused
+};
+
+// Castling shares its bits on both sides, decoding yields CASTLE_KINGSIDE
+// and the target file tells the queenside apart
+constexpr MoveTypeTables generateMoveTypeTables() {
+    MoveTypeTables tables{};
+    for (int type = MOVE_TYPES_COUNT - 1; type >= 0; type--) {
+        tables.bits[type] = moveTypeBits(static_cast<MoveType>(type));
+        tables.types[tables.bits[type]] = type;
+    }
+    return tables;
+}
+
+constexpr MoveTypeTables moveTypeTables = generateMoveTypeTables();
+
+u_int32_t Move::createBinary(Square from, Square to, MoveType type) {
+    return from | (to << 6) | (moveTypeTables.bits[type] << 12);
 }
 
 Move::Move(u_int32_t binary) {
@@ -190,15 +173,8 @@ Move::Move(u_int32_t binary) {
     isEnpassant = (binary >> 22) & 1;                     // bit 22
     isCastling = (binary >> 23) & 1;                      // bit 23
 
-    auto key = std::make_tuple(piece, promoted, isCapture, isDoublePush,
-                               isEnpassant, isCastling);
-
-    auto _moveType = moveTypeMap.find(key);
-    type = (_moveType != moveTypeMap.end()) ? _moveType->second : PAWN_PUSH;
-
-    if (isCastling && (to == c8 || to == c1)) {
-        type = CASTLE_QUEENSIDE;
-    }
+    type = static_cast<MoveType>(moveTypeTables.types[(binary >> 12) & 0xfff] +
+                                 (isCastling && to % 8 == 2));
 }
 
 std::string Move::toString() const {
@@ -0,0 +1,63 @@
+#include "perft-table.h"
+
+#include <algorithm>
+
+// Packed data: bits 0-7 depth, bits 8-63 node count
+uint64_t packPerftEntry(int depth, long long int nodes) {
+    return ((uint64_t)nodes << 8) | (uint8_t)depth;
+}
+
+bool probeSlot(const std::atomic<uint64_t>& checkSlot,
+               const std::atomic<uint64_t>& dataSlot, uint64_t key, int depth,
+               long long int& nodes) {
+    uint64_t data = dataSlot.load(std::memory_order_relaxed);
+    uint64_t check = checkSlot.load(std::memory_order_relaxed);
+
+    if (!data || (check ^ data) != key || (int)(data & 0xff) != depth) {
+        return false;
+    }
+    nodes = (long long int)(data >> 8);
+    return true;
+}
+
+PerftTable::PerftTable(size_t megabytes) {
+    size_t bytes = std::max<size_t>(megabytes, 1) * 1024 * 1024;
+
+    // Largest power of two that fits, so the bucket index is a simple mask
+    bucketsCount_ = 1;
+    while (bucketsCount_ * 2 * sizeof(Bucket) <= bytes) {
+        bucketsCount_ *= 2;
+    }
+
+    buckets_.reset(new Bucket[bucketsCount_]);
+    clear();
+}
+
+void PerftTable::clear() {
+    for (size_t index = 0; index < bucketsCount_; index++) {
+        for (Slot* slot : {&buckets_[index].deepest, &buckets_[index].recent}) {
+            slot->check.store(0, std::memory_order_relaxed);
+            slot->data.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+bool PerftTable::probe(uint64_t key, int depth, long long int& nodes) const {
+    const Bucket& bucket = buckets_[key & (bucketsCount_ - 1)];
+    return probeSlot(bucket.deepest.check, bucket.deepest.data, key, depth,
+                     nodes) ||
+           probeSlot(bucket.recent.check, bucket.recent.data, key, depth,
+                     nodes);
+}
+
+void PerftTable::store(uint64_t key, int depth, long long int nodes) {
+    Bucket& bucket = buckets_[key & (bucketsCount_ - 1)];
+
+    uint64_t deepestData = bucket.deepest.data.load(std::memory_order_relaxed);
+    Slot& slot =
+        depth >= (int)(deepestData & 0xff) ? bucket.deepest : bucket.recent;
+
+    uint64_t data = packPerftEntry(depth, nodes);
+    slot.data.store(data, std::memory_order_relaxed);
+    slot.check.store(key ^ data, std::memory_order_relaxed);
+}
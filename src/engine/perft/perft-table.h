@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/*
+  Cache of perft subtree sizes keyed by (position hash, remaining depth).
+
+  Shared by the parallel perft workers without locks: every slot keeps the
+  packed data and key ^ data, so a slot torn by two concurrent writers
+  fails the check and reads as a miss.
+
+  Each bucket has two slots, the first keeps the deepest subtree seen, the
+  second is always replaced.
+*/
+class PerftTable {
+   public:
+    explicit PerftTable(size_t megabytes);
+
+    void clear();
+
+    bool probe(uint64_t key, int depth, long long int& nodes) const;
+    void store(uint64_t key, int depth, long long int nodes);
+
+    size_t entriesCount() const { return bucketsCount_ * 2; }
+
+   private:
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(32) Bucket {
+        Slot deepest;
+        Slot recent;
+    };
+
+    std::unique_ptr<Bucket[]> buckets_;
+    size_t bucketsCount_ = 0;
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+const int INFINITE_SCORE = 50000;
+const int MATE_SCORE = 49000;  // mated at ply p scores -MATE_SCORE + p
+
+// Scores beyond this bound are mate scores, measured in plies from the root
+const int MATE_BOUND = MATE_SCORE - 1000;
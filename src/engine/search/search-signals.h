@@ -0,0 +1,19 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Flags written by the UCI input thread and polled by the search threads
+struct SearchSignals {
+    std::atomic<bool> stop{false};
+
+    // Set by "go ponder", cleared by "ponderhit": the clock is ignored
+    // until then
+    std::atomic<bool> ponder{false};
+
+    // Nodes of all the search threads, published every TIME_CHECK_NODES
+    std::atomic<uint64_t> nodes{0};
+
+    // The part of nodes searched by quiescence, published along with them
+    std::atomic<uint64_t> qnodes{0};
+};
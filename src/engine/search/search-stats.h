@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Counters of one search thread, reset by every search
+struct SearchStats {
+    uint64_t betaCutoffs = 0;
+    uint64_t firstMoveCutoffs = 0;  // Cutoffs by the first move searched
+
+    uint64_t nullMoveTries = 0;
+    uint64_t nullMoveCutoffs = 0;
+
+    uint64_t lateMoveReductions = 0;
+    uint64_t lateMoveResearches = 0;  // Reduced moves which beat alpha
+
+    // Share of the cutoffs found on the first move, the closer to one the
+    // better the move ordering
+    double firstMoveCutoffRate() const {
+        return betaCutoffs ? (double)firstMoveCutoffs / betaCutoffs : 0;
+    }
+};
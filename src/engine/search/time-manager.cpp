@@ -0,0 +1,55 @@
+#include "time-manager.h"
+
+#include <algorithm>
+
+// Moves left assumed when the GUI does not send movestogo
+const int DEFAULT_MOVES_TO_GO = 30;
+
+void TimeManager::start(const SearchLimits& limits, Color side) {
+    startTime_ = std::chrono::steady_clock::now();
+    softLimit_ = -1;
+    hardLimit_ = -1;
+
+    if (limits.infinite) {
+        return;
+    }
+
+    if (limits.movetime >= 0) {
+        softLimit_ = std::max<int64_t>(limits.movetime - MOVE_OVERHEAD_MS, 1);
+        hardLimit_ = softLimit_;
+        return;
+    }
+
+    int64_t time = side == WHITE ? limits.wtime : limits.btime;
+    int64_t increment = side == WHITE ? limits.winc : limits.binc;
+    if (time < 0) {
+        return;
+    }
+
+    int movesToGo =
+        limits.movestogo > 0 ? limits.movestogo : DEFAULT_MOVES_TO_GO;
+    int64_t available = std::max<int64_t>(time - MOVE_OVERHEAD_MS, 1);
+
+    softLimit_ = available / movesToGo + increment * 3 / 4;
+    hardLimit_ = std::min(softLimit_ * 4, available / 3);
+
+    // Never plan past the remaining time, even with a large increment
+    hardLimit_ = std::max<int64_t>(std::min(hardLimit_, available), 1);
+    softLimit_ = std::max<int64_t>(std::min(softLimit_, hardLimit_), 1);
+}
+
+void TimeManager::restart() { startTime_ = std::chrono::steady_clock::now(); }
+
+int64_t TimeManager::elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now() - startTime_)
+        .count();
+}
+
+bool TimeManager::softLimitReached() const {
+    return softLimit_ >= 0 && elapsed() >= softLimit_;
+}
+
+bool TimeManager::hardLimitReached() const {
+    return hardLimit_ >= 0 && elapsed() >= hardLimit_;
+}
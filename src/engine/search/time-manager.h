@@ -0,0 +1,57 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "../chessboard/color.h"
+
+const int MAX_SEARCH_DEPTH = 64;
+const int MAX_PLY = 128;  // Quiescence included
+const int MAX_THREADS = 256;
+
+// Keeps a margin for the GUI and the process to send the move
+const int64_t MOVE_OVERHEAD_MS = 30;
+
+// Nodes searched between two clock reads
+const uint64_t TIME_CHECK_NODES = 2048;
+
+// Parameters of a UCI go command, -1 when not given
+struct SearchLimits {
+    int depth = -1;
+    int64_t wtime = -1;
+    int64_t btime = -1;
+    int64_t winc = 0;
+    int64_t binc = 0;
+    int movestogo = -1;
+    int64_t movetime = -1;
+    bool infinite = false;
+    bool ponder = false;
+};
+
+/*
+  Turns the clock parameters into two budgets:
+
+    soft  no new iteration is started once it has elapsed
+    hard  the running iteration is aborted once it has elapsed
+
+  Both are unlimited (-1) for depth only or infinite searches.
+*/
+class TimeManager {
+   public:
+    void start(const SearchLimits& limits, Color side);
+
+    // Starts counting again from now, used on ponderhit
+    void restart();
+
+    int64_t elapsed() const;
+    bool softLimitReached() const;
+    bool hardLimitReached() const;
+
+    int64_t softLimit() const { return softLimit_; }
+    int64_t hardLimit() const { return hardLimit_; }
+
+   private:
+    std::chrono::steady_clock::time_point startTime_;
+    int64_t softLimit_ = -1;
+    int64_t hardLimit_ = -1;
+};
@@ -0,0 +1,137 @@
+#include "transposition-table.h"
+
+#include <algorithm>
+
+/*
+  Packed entry data:
+
+    bits  0-23    move binary
+    bits 24-41    score (18 bits signed, mate scores exceed int16)
+    bits 42-49    depth
+    bits 50-51    bound
+    bits 52-57    age (search generation)
+*/
+const int SCORE_BITS = 18;
+const uint64_t SCORE_MASK = (1ULL << SCORE_BITS) - 1;
+const int AGE_BITS = 6;
+const int AGE_MASK = (1 << AGE_BITS) - 1;
+
+uint64_t packEntry(uint32_t move, int score, int depth, Bound bound,
+                   uint8_t age) {
+    return (uint64_t)(move & 0xffffff) |
+           (((uint64_t)score & SCORE_MASK) << 24) |
+           ((uint64_t)std::clamp(depth, 0, 255) << 42) |
+           ((uint64_t)bound << 50) | ((uint64_t)(age & AGE_MASK) << 52);
+}
+
+TranspositionEntry unpackEntry(uint64_t data) {
+    // Sign extend the score field
+    int score = static_cast<int>((data >> 24) & SCORE_MASK);
+    if (score & (1 << (SCORE_BITS - 1))) {
+        score -= 1 << SCORE_BITS;
+    }
+
+    return TranspositionEntry{
+        static_cast<uint32_t>(data & 0xffffff),
+        score,
+        static_cast<int>((data >> 42) & 0xff),
+        static_cast<Bound>((data >> 50) & 0x3),
+    };
+}
+
+uint8_t entryAge(uint64_t data) { return (data >> 52) & AGE_MASK; }
+
+TranspositionTable::TranspositionTable(size_t megabytes) { resize(megabytes); }
+
+void TranspositionTable::resize(size_t megabytes) {
+    size_t bytes = std::max<size_t>(megabytes, 1) * 1024 * 1024;
+
+    // Largest power of two that fits, so the bucket index is a simple mask
+    bucketsCount_ = 1;
+    while (bucketsCount_ * 2 * sizeof(Bucket) <= bytes) {
+        bucketsCount_ *= 2;
+    }
+
+    buckets_.reset(new Bucket[bucketsCount_]);
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (size_t index = 0; index < bucketsCount_; index++) {
+        for (Slot& slot : buckets_[index].slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    age_ = 0;
+}
+
+void TranspositionTable::newSearch() { age_ = (age_ + 1) & AGE_MASK; }
+
+TranspositionTable::Bucket& TranspositionTable::bucketFor(
+    uint64_t key) const {
+    return buckets_[key & (bucketsCount_ - 1)];
+}
+
+bool TranspositionTable::probe(uint64_t key, TranspositionEntry& entry) const {
+    for (const Slot& slot : bucketFor(key).slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+        if (data && (check ^ data) == key) {
+            entry = unpackEntry(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, uint32_t move, int score,
+                               int depth, Bound bound) {
+    Bucket& bucket = bucketFor(key);
+
+    // Same position first, otherwise the shallowest and oldest entry
+    Slot* replace = nullptr;
+    int replaceValue = 0;
+    for (Slot& slot : bucket.slots) {
+        uint64_t data = slot.data.load(std::memory_order_relaxed);
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+        if (!data || (check ^ data) == key) {
+            if (data && !move) {
+                move = unpackEntry(data).move;  // keep the known best move
+            }
+            replace = &slot;
+            break;
+        }
+
+        int age = (age_ - entryAge(data)) & AGE_MASK;
+        int value = unpackEntry(data).depth - 8 * age;
+        if (!replace || value < replaceValue) {
+            replace = &slot;
+            replaceValue = value;
+        }
+    }
+
+    uint64_t data = packEntry(move, score, depth, bound, age_);
+    replace->data.store(data, std::memory_order_relaxed);
+    replace->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+size_t TranspositionTable::entriesCount() const {
+    return bucketsCount_ * BUCKET_SIZE;
+}
+
+int TranspositionTable::hashfull() const {
+    int used = 0;
+    size_t samples = std::min<size_t>(bucketsCount_, 250);
+    for (size_t index = 0; index < samples; index++) {
+        for (const Slot& slot : buckets_[index].slots) {
+            uint64_t data = slot.data.load(std::memory_order_relaxed);
+            if (data && entryAge(data) == age_) {
+                used++;
+            }
+        }
+    }
+    return used * 1000 / (samples * BUCKET_SIZE);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+const size_t DEFAULT_HASH_MB = 16;
+
+enum Bound : uint8_t {
+    BOUND_NONE,
+    BOUND_UPPER,  // Failed low, the real score is at most score
+    BOUND_LOWER,  // Failed high, the real score is at least score
+    BOUND_EXACT,
+};
+
+struct TranspositionEntry {
+    uint32_t move;  // Move binary (24 bits), 0 when there is no best move
+    int score;
+    int depth;
+    Bound bound;
+};
+
+/*
+  Fixed size hash table shared by every search thread.
+
+  Each bucket is one cache line holding four entries, each entry is two
+  64-bit words: the packed data and key ^ data. A reader only accepts an
+  entry when check ^ data gives back its key, so an entry torn by a
+  concurrent writer is seen as a miss and no lock is needed (Hyatt's
+  lockless hashing).
+*/
+class TranspositionTable {
+   public:
+    explicit TranspositionTable(size_t megabytes = DEFAULT_HASH_MB);
+
+    void resize(size_t megabytes);
+    void clear();
+    void newSearch();
+
+    bool probe(uint64_t key, TranspositionEntry& entry) const;
+    void store(uint64_t key, uint32_t move, int score, int depth, Bound bound);
+
+    size_t entriesCount() const;
+    int hashfull() const;
+
+   private:
+    static const int BUCKET_SIZE = 4;
+
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[BUCKET_SIZE];
+    };
+
+    std::unique_ptr<Bucket[]> buckets_;
+    size_t bucketsCount_ = 0;
+    uint8_t age_ = 0;
+
+    Bucket& bucketFor(uint64_t key) const;
+};
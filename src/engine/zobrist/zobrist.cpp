@@ -0,0 +1,37 @@
+#include "zobrist.h"
+
+/*
+  Keys are generated at compile time with splitmix64, so they are the same
+  on every run and there is no static initialization order to worry about.
+*/
+constexpr uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+constexpr ZobristKeys generateZobristKeys() {
+    ZobristKeys keys{};
+    uint64_t state = 1804289383;
+
+    for (int pieceBoard = 0; pieceBoard < 12; pieceBoard++) {
+        for (int square = 0; square < 64; square++) {
+            keys.pieces[pieceBoard][square] = nextRandom(state);
+        }
+    }
+
+    keys.side = nextRandom(state);
+
+    for (int castle = 0; castle < 16; castle++) {
+        keys.castling[castle] = nextRandom(state);
+    }
+
+    for (int file = 0; file < 8; file++) {
+        keys.enpassantFiles[file] = nextRandom(state);
+    }
+
+    return keys;
+}
+
+constexpr ZobristKeys zobristKeys = generateZobristKeys();
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include "../chessboard/square.h"
+
+struct ZobristKeys {
+    uint64_t pieces[12][64];  // indexed by PieceBoard and Square
+    uint64_t side;            // xored in when black is to move
+    uint64_t castling[16];    // indexed by availableCastle
+    uint64_t enpassantFiles[8];
+};
+
+extern const ZobristKeys zobristKeys;
+
+inline uint64_t zobristEnpassantKey(const std::optional<Square>& enpassant) {
+    return enpassant.has_value()
+               ? zobristKeys.enpassantFiles[enpassant.value() % 8]
+               : 0ULL;
+}
@@ -15,6 +15,24 @@ void parseSingleInput(char* arg, CommandLineArgs* args) {
                 args->logEnable = false;
             } else if (strncmp(arg, "--log-level=", 12) == 0) {
                 args->logLevel = std::stoi(arg + 12);
+            } else if (strncmp(arg, "--perft=", 8) == 0) {
+                args->perftDepth = std::stoi(arg + 8);
+            } else if (strcmp(arg, "--undo=snapshot") == 0) {
+                args->snapshotUndo = true;
+            } else if (strcmp(arg, "--undo=incremental") == 0) {
+                args->snapshotUndo = false;
+            } else if (strcmp(arg, "--movegen=pseudo") == 0) {
+                args->pseudoLegalMovegen = true;
+            } else if (strcmp(arg, "--movegen=legal") == 0) {
+                args->pseudoLegalMovegen = false;
+            } else if (strcmp(arg, "--perft-verify-hash") == 0) {
+                args->perftVerifyHash = true;
+            } else if (strncmp(arg, "--perft-threads=", 16) == 0) {
+                args->perftThreads = std::stoi(arg + 16);
+            } else if (strncmp(arg, "--perft-split=", 14) == 0) {
+                args->perftSplitDepth = std::stoi(arg + 14);
+            } else if (strncmp(arg, "--perft-hash=", 13) == 0) {
+                args->perftHashMb = std::stoi(arg + 13);
             } else {
                 std::cout << "Unknown option: " << arg << std::endl;
             }
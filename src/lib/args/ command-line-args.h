@@ -7,6 +7,13 @@ struct CommandLineArgs {
     bool uciMode = false;
     int logLevel = 0;
     bool logEnable = true;
+    int perftDepth = 0;
+    bool snapshotUndo = false;
+    bool pseudoLegalMovegen = false;
+    bool perftVerifyHash = false;
+    int perftThreads = 1;
+    int perftSplitDepth = 2;
+    int perftHashMb = 0;
 };
 
 class CommandLineParser {
@@ -32,6 +32,11 @@ class Logger {
 
     void log(LogLevel level, const std::string& message) const;
 
+    // Lets hot paths skip building messages that would be dropped
+    bool isEnabled(LogLevel level) const {
+        return props_.enabled && level >= props_.minLevel;
+    }
+
     void debug(const std::string& message) const;
     void info(const std::string& message) const;
     void warn(const std::string& message) const;
@@ -0,0 +1,64 @@
+#include "thread-pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t workersCount) {
+    workersCount = std::max<size_t>(workersCount, 1);
+    for (size_t index = 0; index < workersCount; index++) {
+        workers_.emplace_back([this, index]() { workerLoop(index); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shuttingDown_ = true;
+    }
+    taskAvailable_.notify_all();
+
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+    taskAvailable_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    allDone_.wait(lock, [this]() { return tasks_.empty() && !runningTasks_; });
+}
+
+void ThreadPool::workerLoop(size_t workerIndex) {
+    while (true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            taskAvailable_.wait(
+                lock, [this]() { return shuttingDown_ || !tasks_.empty(); });
+
+            if (tasks_.empty()) {
+                return;  // shutting down and nothing left to run
+            }
+
+            task = std::move(tasks_.front());
+            tasks_.pop();
+            runningTasks_++;
+        }
+
+        task(workerIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            runningTasks_--;
+            if (tasks_.empty() && !runningTasks_) {
+                allDone_.notify_all();
+            }
+        }
+    }
+}
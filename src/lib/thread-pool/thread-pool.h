@@ -0,0 +1,46 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/*
+  Fixed set of worker threads consuming a FIFO of tasks.
+
+  A task receives the index of the worker running it, so callers can keep
+  per-worker state (an engine copy, a counter) without any locking.
+*/
+class ThreadPool {
+   public:
+    using Task = std::function<void(size_t workerIndex)>;
+
+    explicit ThreadPool(size_t workersCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void enqueue(Task task);
+
+    // Blocks until every enqueued task has run
+    void wait();
+
+    size_t size() const { return workers_.size(); }
+
+   private:
+    std::vector<std::thread> workers_;
+    std::queue<Task> tasks_;
+
+    std::mutex mutex_;
+    std::condition_variable taskAvailable_;
+    std::condition_variable allDone_;
+
+    size_t runningTasks_ = 0;
+    bool shuttingDown_ = false;
+
+    void workerLoop(size_t workerIndex);
+};
@@ -3,17 +3,16 @@
 #include <cstring>
 #include <iostream>
 
+#include "../engine/attacks/attacks.h"
 #include "../engine/chessboard/square.h"
 #include "../engine/masks/masks.h"
 
 MagicNumberGenerator::MagicNumberGenerator() {
     prng_ = PseudoRandomNumberGenerator();
-    engine_ = Engine();
 }
 
 MagicNumberGenerator::MagicNumberGenerator(PseudoRandomNumberGenerator prng) {
     prng_ = prng;
-    engine_ = Engine();
 }
 
 uint64_t MagicNumberGenerator::findMagicNumber(Square square, int relevantBits,
@@ -23,20 +22,18 @@ uint64_t MagicNumberGenerator::findMagicNumber(Square square, int relevantBits,
     Bitboard usedAttacks[4096];
 
     Bitboard attackMasks =
-        piece == IS_BISHOP
-            ? engine_.generateSingleBishopRelevantOccupanciesMask(square)
-            : engine_.generateSingleRookRelevantOccupanciesMask(square);
+        piece == IS_BISHOP ? generateSingleBishopRelevantOccupanciesMask(square)
+                           : generateSingleRookRelevantOccupanciesMask(square);
 
     int occupancyIndecies = 1 << relevantBits;
 
     for (int index = 0; index < occupancyIndecies; index++) {
-        occupancies[index] = engine_.setOccupancy(index, attackMasks);
+        occupancies[index] = setOccupancy(index, attackMasks);
 
         attacks[index] =
             piece == IS_BISHOP
-                ? engine_.generateSingleBishopAttacks(square,
-                                                      occupancies[index])
-                : engine_.generateSingleRookAttacks(square, occupancies[index]);
+                ? generateSingleBishopAttacks(square, occupancies[index])
+                : generateSingleRookAttacks(square, occupancies[index]);
     }
 
     for (int randomCount = 0; randomCount < 100000000; randomCount++) {
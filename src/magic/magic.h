@@ -5,13 +5,13 @@
 
 #include "../bitboard/bitboard.h"
 #include "../engine/chessboard/chessboard-status.h"
-#include "../engine/engine.h"
+#include "../engine/chessboard/sliding-piece.h"
+#include "../engine/chessboard/square.h"
 #include "random.h"
 
 class MagicNumberGenerator {
    private:
     PseudoRandomNumberGenerator prng_;
-    Engine engine_;
 
    public:
     MagicNumberGenerator();
@@ -3,6 +3,7 @@ using namespace std;
 #include <bitset>
 #include <cstring>
 #include <iostream>
+#include <thread>
 
 #include "bitboard/bitboard.h"
 #include "engine/chessboard/chessboard.h"
@@ -30,11 +31,30 @@ int main(int argc, char* argv[]) {
 
     Engine engine;
     engine.init();
+    engine.board.undoMode =
+        args.snapshotUndo ? UNDO_SNAPSHOT : UNDO_INCREMENTAL;
+    engine.generationMode =
+        args.pseudoLegalMovegen ? GENERATE_PSEUDO_LEGAL : GENERATE_LEGAL;
+
+    if (args.perftDepth > 0) {
+        engine.verifyHashKeys = args.perftVerifyHash;
+        engine.perftThreads = args.perftThreads > 0
+                                  ? args.perftThreads
+                                  : std::thread::hardware_concurrency();
+        engine.perftSplitDepth = args.perftSplitDepth;
+        if (args.perftHashMb > 0) {
+            engine.perftTable = std::make_shared<PerftTable>(args.perftHashMb);
+        }
+        engine.setupInitialPosition();
+        engine.perfTest(args.perftDepth);
+        return 0;
+    }
 
     if (uciMode) {
         logger.info("Starint in UCI mode");
         engine.setupInitialPosition();
         engine.UCI();
+        return 0;
     }
 
     // DEBUG
@@ -4,6 +4,19 @@
 #include "../src/engine/chessboard/square.h"
 #include "test_lib.h"
 
+bool sameStatus(const ChessboardStatus& a, const ChessboardStatus& b) {
+    for (int boardsIndex = 0; boardsIndex < BOARDS_COUNTER; boardsIndex++) {
+        if (a.boards[boardsIndex] != b.boards[boardsIndex]) {
+            return false;
+        }
+    }
+    return a.side == b.side && a.enpassant == b.enpassant &&
+           a.availableCastle == b.availableCastle &&
+           a.halfmoveCounter == b.halfmoveCounter &&
+           a.fullmoveNumber == b.fullmoveNumber && a.hashKey == b.hashKey &&
+           a.scores == b.scores;
+}
+
 void run_chessboard_tests() {
     describe("Testing chessboard", []() {
         it("Testing board initialization", []() {
@@ -213,7 +226,7 @@ void run_chessboard_tests() {
                 expect(board.status.enpassant.value() == e3);
 
                 expect(board.moveHistory.size() == 1);
-                expect(board.statusHistory.size() == 1);
+                expect(board.undoHistory.size() == 1);
 
                 board.undoLastMove();
 
@@ -222,7 +235,7 @@ void run_chessboard_tests() {
                 expect(board.status.side == WHITE);
                 expect(!board.status.enpassant.has_value());
                 expect(board.moveHistory.size() == 0);
-                expect(board.statusHistory.size() == 0);
+                expect(board.undoHistory.size() == 0);
             });
 
             it("Testing knight move Ng1-f3 from initial position", []() {
@@ -245,7 +258,7 @@ void run_chessboard_tests() {
                 expect(board.getPieceAt(f3) == '.');
                 expect(board.status.side == WHITE);
                 expect(board.moveHistory.size() == 0);
-                expect(board.statusHistory.size() == 0);
+                expect(board.undoHistory.size() == 0);
                 expect(!board.status.enpassant.has_value());
             });
 
@@ -859,5 +872,283 @@ void run_chessboard_tests() {
                 expect(board.status.fullmoveNumber == 2);
             });
         });
+
+        describe("Testing incremental and snapshot undo", []() {
+            std::vector<std::pair<std::string, Move>> cases = {
+                {"rnbqkbnr/ppp1pppp/8/3p4/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - "
+                 "0 2",
+                 Move(e4, d5, PAWN_CAPTURE)},
+                {"rnbqkbnr/ppp1p1pp/8/3pPp2/8/8/PPPP1PPP/RNBQKBNR w KQkq f6 "
+                 "0 3",
+                 Move(e5, f6, PAWN_CAPTURE_ENPASSANT)},
+                {"rnbqkbnr/ppp1pppp/8/8/3pP3/8/PPPP1PPP/RNBQKBNR b KQkq e3 "
+                 "0 3",
+                 Move(d4, e3, PAWN_CAPTURE_ENPASSANT)},
+                {"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 4 10",
+                 Move(e1, g1, CASTLE_KINGSIDE)},
+                {"r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 4 10",
+                 Move(e8, c8, CASTLE_QUEENSIDE)},
+                {"r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 4 10",
+                 Move(a1, a8, ROOK_CAPTURE)},
+                {"4k3/8/8/8/8/8/6p1/5R1K b - - 0 1",
+                 Move(g2, f1, PAWN_CAPTURE_PROMOTION_TO_KNIGHT)},
+                {"4k3/P7/8/8/8/8/8/4K3 w - - 0 1",
+                 Move(a7, a8, PAWN_PROMOTION_TO_QUEEN)},
+                {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+                 Move(e2, e4, PAWN_DOUBLE_PUSH)},
+            };
+
+            for (auto& [fen, move] : cases) {
+                it("Testing undo restores status for " + fen, [&]() {
+                    for (UndoMode mode : {UNDO_INCREMENTAL, UNDO_SNAPSHOT}) {
+                        ChessBoard board;
+                        board.undoMode = mode;
+                        board.parseFEN(fen);
+                        ChessboardStatus before = board.status;
+
+                        board.makePsuedoLegalMove(move);
+                        expect(!sameStatus(before, board.status));
+
+                        board.undoLastMove();
+                        expect(sameStatus(before, board.status));
+                        expect(board.moveHistory.empty());
+                        expect(board.statusHistory.empty());
+                        expect(board.undoHistory.empty());
+                    }
+                });
+            }
+
+            it("Testing both modes end up in the same status", []() {
+                ChessBoard incremental;
+                ChessBoard snapshot;
+                snapshot.undoMode = UNDO_SNAPSHOT;
+                incremental.setupInitialPosition();
+                snapshot.setupInitialPosition();
+
+                Move moves[] = {
+                    Move(e2, e4, PAWN_DOUBLE_PUSH),
+                    Move(d7, d5, PAWN_DOUBLE_PUSH),
+                    Move(e4, d5, PAWN_CAPTURE),
+                    Move(d8, d5, QUEEN_CAPTURE),
+                    Move(b1, c3, KNIGHT_QUIET),
+                    Move(d5, a2, QUEEN_CAPTURE),
+                };
+                for (const Move& move : moves) {
+                    incremental.makePsuedoLegalMove(move);
+                    snapshot.makePsuedoLegalMove(move);
+                    expect(sameStatus(incremental.status, snapshot.status));
+                    expect(incremental.isOccupancyConsistent());
+                }
+                for (int i = 0; i < 6; i++) {
+                    incremental.undoLastMove();
+                    snapshot.undoLastMove();
+                    expect(sameStatus(incremental.status, snapshot.status));
+                    expect(incremental.isOccupancyConsistent());
+                }
+            });
+
+            it("Testing set and clear piece keep occupancy consistent", []() {
+                ChessBoard board;
+                board.setupInitialPosition();
+                board.clearPieceAt(e2);
+                board.setPieceAt(e4, 'P');
+                board.setPieceAt(e4, 'P');
+                board.clearPieceAt(e5);
+                board.clearPieceAt(d8);
+                board.setPieceAt(h5, 'q');
+
+                expect(board.isOccupancyConsistent());
+                expect(board.status.boards[ALL_PIECES].popCount() == 32);
+                expect(board.status.boards[WHITE_ALL].getBit(e4));
+                expect(!board.status.boards[WHITE_ALL].getBit(e2));
+                expect(board.status.boards[BLACK_ALL].getBit(h5));
+                expect(!board.status.boards[ALL_PIECES].getBit(d8));
+            });
+        });
+
+        describe("Testing zobrist hash key", []() {
+            it("Testing transpositions share the same key", []() {
+                ChessBoard board;
+                board.setupInitialPosition();
+                uint64_t initialKey = board.status.hashKey;
+
+                board.makePsuedoLegalMove(Move(g1, f3, KNIGHT_QUIET));
+                board.makePsuedoLegalMove(Move(g8, f6, KNIGHT_QUIET));
+                board.makePsuedoLegalMove(Move(f3, g1, KNIGHT_QUIET));
+                expect(board.status.hashKey != initialKey);
+                board.makePsuedoLegalMove(Move(f6, g8, KNIGHT_QUIET));
+
+                expect(board.status.hashKey == initialKey);
+                expect(board.status.hashKey == board.computeHashKey());
+            });
+
+            it("Testing incremental key matches parseFEN", []() {
+                ChessBoard board;
+                board.setupInitialPosition();
+                board.makePsuedoLegalMove(Move(e2, e4, PAWN_DOUBLE_PUSH));
+                board.makePsuedoLegalMove(Move(e7, e5, PAWN_DOUBLE_PUSH));
+                board.makePsuedoLegalMove(Move(e1, e2, KING_QUIET));
+
+                ChessBoard expected;
+                expected.parseFEN(
+                    "rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPPKPPP/RNBQ1BNR b kq - 1 "
+                    "2");
+                expect(board.status.hashKey == expected.status.hashKey);
+            });
+
+            it("Testing side, castling and en passant change the key", []() {
+                ChessBoard white;
+                ChessBoard black;
+                ChessBoard noCastle;
+                ChessBoard enpassant;
+                white.parseFEN("r3k2r/8/8/3pP3/8/8/8/R3K2R w KQkq - 0 1");
+                black.parseFEN("r3k2r/8/8/3pP3/8/8/8/R3K2R b KQkq - 0 1");
+                noCastle.parseFEN("r3k2r/8/8/3pP3/8/8/8/R3K2R w Kkq - 0 1");
+                enpassant.parseFEN("r3k2r/8/8/3pP3/8/8/8/R3K2R w KQkq d6 0 1");
+
+                expect(white.status.hashKey != black.status.hashKey);
+                expect(white.status.hashKey != noCastle.status.hashKey);
+                expect(white.status.hashKey != enpassant.status.hashKey);
+            });
+
+            it("Testing key through captures, promotions and castling", []() {
+                ChessBoard board;
+                board.parseFEN("r3k2r/8/8/3pP3/8/8/6p1/R3K2R w KQkq d6 0 1");
+                uint64_t initialKey = board.status.hashKey;
+
+                board.makePsuedoLegalMove(Move(e5, d6, PAWN_CAPTURE_ENPASSANT));
+                expect(board.status.hashKey == board.computeHashKey());
+                board.makePsuedoLegalMove(
+                    Move(g2, h1, PAWN_CAPTURE_PROMOTION_TO_QUEEN));
+                expect(board.status.hashKey == board.computeHashKey());
+                board.makePsuedoLegalMove(Move(e1, c1, CASTLE_QUEENSIDE));
+                expect(board.status.hashKey == board.computeHashKey());
+
+                board.undoLastMove();
+                board.undoLastMove();
+                board.undoLastMove();
+                expect(board.status.hashKey == initialKey);
+            });
+        });
+
+        describe("Testing mailbox", []() {
+            it("Testing mailbox after initial position setup", []() {
+                ChessBoard board;
+                board.setupInitialPosition();
+                expect(board.isMailboxConsistent());
+                expect(board.pieceOn(e1) == WHITE_KING);
+                expect(board.pieceOn(d8) == BLACK_QUEEN);
+                expect(board.pieceOn(b1) == WHITE_KNIGHTS);
+                expect(board.pieceOn(h7) == BLACK_PAWNS);
+                expect(board.pieceOn(e4) == NO_PIECE);
+            });
+
+            it("Testing mailbox after parseFEN", []() {
+                ChessBoard board;
+                board.parseFEN("4k3/8/8/8/8/8/6p1/5R1K b - - 0 1");
+                expect(board.isMailboxConsistent());
+                expect(board.pieceOn(g2) == BLACK_PAWNS);
+                expect(board.pieceOn(f1) == WHITE_ROOKS);
+                expect(board.pieceOn(a1) == NO_PIECE);
+            });
+
+            it("Testing mailbox through make and undo", []() {
+                ChessBoard board;
+                board.parseFEN("r3k2r/8/8/3pP3/8/8/6p1/R3K2R w KQkq d6 0 1");
+
+                board.makePsuedoLegalMove(Move(e5, d6, PAWN_CAPTURE_ENPASSANT));
+                expect(board.pieceOn(d6) == WHITE_PAWNS);
+                expect(board.pieceOn(d5) == NO_PIECE);
+                expect(board.pieceOn(e5) == NO_PIECE);
+
+                board.makePsuedoLegalMove(
+                    Move(g2, h1, PAWN_CAPTURE_PROMOTION_TO_QUEEN));
+                expect(board.pieceOn(h1) == BLACK_QUEEN);
+                expect(board.pieceOn(g2) == NO_PIECE);
+
+                board.makePsuedoLegalMove(Move(e1, c1, CASTLE_QUEENSIDE));
+                expect(board.pieceOn(c1) == WHITE_KING);
+                expect(board.pieceOn(d1) == WHITE_ROOKS);
+                expect(board.pieceOn(a1) == NO_PIECE);
+                expect(board.isMailboxConsistent());
+
+                board.undoLastMove();
+                board.undoLastMove();
+                board.undoLastMove();
+                expect(board.isMailboxConsistent());
+                expect(board.pieceOn(e5) == WHITE_PAWNS);
+                expect(board.pieceOn(d5) == BLACK_PAWNS);
+                expect(board.pieceOn(g2) == BLACK_PAWNS);
+                expect(board.pieceOn(h1) == WHITE_ROOKS);
+                expect(board.pieceOn(a1) == WHITE_ROOKS);
+                expect(board.pieceOn(e1) == WHITE_KING);
+                expect(board.pieceOn(d6) == NO_PIECE);
+            });
+        });
+
+        describe("Testing evaluation scores", []() {
+            it("Testing the initial position is balanced", []() {
+                ChessBoard board;
+                board.setupInitialPosition();
+                expect(board.isScoresConsistent());
+                expect(board.status.scores.middleGame == 0);
+                expect(board.status.scores.endGame == 0);
+                expect(board.status.scores.phase == MAX_GAME_PHASE);
+            });
+
+            it("Testing scores through captures, promotions and castling",
+               []() {
+                   ChessBoard board;
+                   board.parseFEN(
+                       "r3k2r/8/8/3pP3/8/8/6p1/R3K2R w KQkq d6 0 1");
+                   ChessboardStatus before = board.status;
+
+                   board.makePsuedoLegalMove(
+                       Move(e5, d6, PAWN_CAPTURE_ENPASSANT));
+                   expect(board.isScoresConsistent());
+                   board.makePsuedoLegalMove(
+                       Move(g2, h1, PAWN_CAPTURE_PROMOTION_TO_QUEEN));
+                   expect(board.isScoresConsistent());
+                   // Three rooks and the new queen
+                   expect(board.status.scores.phase == 3 * 2 + 4);
+                   board.makePsuedoLegalMove(Move(e1, c1, CASTLE_QUEENSIDE));
+                   expect(board.isScoresConsistent());
+
+                   board.undoLastMove();
+                   board.undoLastMove();
+                   board.undoLastMove();
+                   expect(sameStatus(board.status, before));
+               });
+
+            it("Testing snapshot undo restores the scores", []() {
+                ChessBoard board;
+                board.undoMode = UNDO_SNAPSHOT;
+                board.setupInitialPosition();
+                board.makePsuedoLegalMove(Move(e2, e4, PAWN_DOUBLE_PUSH));
+                expect(board.status.scores.middleGame > 0);
+                board.undoLastMove();
+                expect(board.status.scores.middleGame == 0);
+            });
+        });
+
+        describe("Testing null move", []() {
+            it("Testing the turn passes and comes back", []() {
+                ChessBoard board;
+                board.parseFEN(
+                    "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 "
+                    "0 2");
+                ChessboardStatus before = board.status;
+
+                std::optional<Square> enpassant = board.makeNullMove();
+                expect(enpassant == d6);
+                expect(board.status.side == BLACK);
+                expect(!board.status.enpassant.has_value());
+                expect(board.status.hashKey == board.computeHashKey());
+                expect(board.moveHistory.empty());
+
+                board.undoNullMove(enpassant);
+                expect(sameStatus(board.status, before));
+            });
+        });
     });
 }
\ No newline at end of file
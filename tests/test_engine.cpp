@@ -1,6 +1,9 @@
 #include <algorithm>
 #include <iostream>
+#include <thread>
+#include <vector>
 
+#include "../src/engine/attacks/attacks.h"
 #include "../src/engine/chessboard/chessboard-status.h"
 #include "../src/engine/chessboard/chessboard.h"
 #include "../src/engine/chessboard/color.h"
@@ -11,11 +14,9 @@
 
 void test_pawn_attacks_generation() {
     describe("Testing pawn attacks generations", []() {
-        Engine engine;
-
         it("Testing pawn attacks on e4 for white", [&]() {
             Bitboard whiteE4Attacks =
-                engine.generateSinglePawnMaskAttacks(e4, WHITE);
+                generateSinglePawnMaskAttacks(e4, WHITE);
             expect(whiteE4Attacks.getBit(d5));
             expect(whiteE4Attacks.getBit(f5));
             expect(whiteE4Attacks.popCount() == 2);
@@ -23,7 +24,7 @@ void test_pawn_attacks_generation() {
 
         it("Testing pawn attacks on e4 for black", [&]() {
             Bitboard blackE4Attacks =
-                engine.generateSinglePawnMaskAttacks(e4, BLACK);
+                generateSinglePawnMaskAttacks(e4, BLACK);
             expect(blackE4Attacks.getBit(d3));
             expect(blackE4Attacks.getBit(f3));
             expect(blackE4Attacks.popCount() == 2);
@@ -31,14 +32,14 @@ void test_pawn_attacks_generation() {
 
         it("Testing pawn attacks on a4 for white", [&]() {
             Bitboard whiteA4Attacks =
-                engine.generateSinglePawnMaskAttacks(a4, WHITE);
+                generateSinglePawnMaskAttacks(a4, WHITE);
             expect(whiteA4Attacks.getBit(b5));
             expect(whiteA4Attacks.popCount() == 1);
         });
 
         it("Testing pawn attacks on h4 for black", [&]() {
             Bitboard blackH4Attacks =
-                engine.generateSinglePawnMaskAttacks(h4, BLACK);
+                generateSinglePawnMaskAttacks(h4, BLACK);
             expect(blackH4Attacks.getBit(g3));
             expect(blackH4Attacks.popCount() == 1);
         });
@@ -47,10 +48,8 @@ void test_pawn_attacks_generation() {
 
 void test_knight_moves_generation() {
     describe("Testing knight move generations", []() {
-        Engine engine;
-
         it("Testing knight possible moves on e4", [&]() {
-            Bitboard e4Attacks = engine.generateSingleKnightAttacksMask(e4);
+            Bitboard e4Attacks = generateSingleKnightAttacksMask(e4);
             expect(e4Attacks.getBit(f6));
             expect(e4Attacks.getBit(g5));
             expect(e4Attacks.getBit(g3));
@@ -63,14 +62,14 @@ void test_knight_moves_generation() {
         });
 
         it("Testing knight possible moves on a1", [&]() {
-            Bitboard a1Attacks = engine.generateSingleKnightAttacksMask(a1);
+            Bitboard a1Attacks = generateSingleKnightAttacksMask(a1);
             expect(a1Attacks.getBit(c2));
             expect(a1Attacks.getBit(b3));
             expect(a1Attacks.popCount() == 2);
         });
 
         it("Testing knight possible moves on a2", [&]() {
-            Bitboard a2Attacks = engine.generateSingleKnightAttacksMask(a2);
+            Bitboard a2Attacks = generateSingleKnightAttacksMask(a2);
             expect(a2Attacks.getBit(b4));
             expect(a2Attacks.getBit(c3));
             expect(a2Attacks.getBit(c1));
@@ -78,7 +77,7 @@ void test_knight_moves_generation() {
         });
 
         it("Testing knight possible moves on g7", [&]() {
-            Bitboard g7Attacks = engine.generateSingleKnightAttacksMask(g7);
+            Bitboard g7Attacks = generateSingleKnightAttacksMask(g7);
             expect(g7Attacks.getBit(h5));
             expect(g7Attacks.getBit(f5));
             expect(g7Attacks.getBit(e6));
@@ -87,7 +86,7 @@ void test_knight_moves_generation() {
         });
 
         it("Testing knight possible moves on g3", [&]() {
-            Bitboard g3Attacks = engine.generateSingleKnightAttacksMask(g3);
+            Bitboard g3Attacks = generateSingleKnightAttacksMask(g3);
             expect(g3Attacks.getBit(h5));
             expect(g3Attacks.getBit(h1));
             expect(g3Attacks.getBit(f1));
@@ -101,10 +100,8 @@ void test_knight_moves_generation() {
 
 void test_king_moves_generation() {
     describe("Testing king move generations", []() {
-        Engine engine;
-
         it("Testing king possible moves on e4", [&]() {
-            Bitboard e4moves = engine.generateSingleKingAttacksMask(e4);
+            Bitboard e4moves = generateSingleKingAttacksMask(e4);
             expect(e4moves.getBit(d5));
             expect(e4moves.getBit(e5));
             expect(e4moves.getBit(f5));
@@ -117,7 +114,7 @@ void test_king_moves_generation() {
         });
 
         it("Testing king possible moves on a1", [&]() {
-            Bitboard a1moves = engine.generateSingleKingAttacksMask(a1);
+            Bitboard a1moves = generateSingleKingAttacksMask(a1);
             expect(a1moves.getBit(a2));
             expect(a1moves.getBit(b2));
             expect(a1moves.getBit(b1));
@@ -125,7 +122,7 @@ void test_king_moves_generation() {
         });
 
         it("Testing king possible moves on a8", [&]() {
-            Bitboard a8Moves = engine.generateSingleKingAttacksMask(a8);
+            Bitboard a8Moves = generateSingleKingAttacksMask(a8);
             expect(a8Moves.getBit(b8));
             expect(a8Moves.getBit(b7));
             expect(a8Moves.getBit(a7));
@@ -133,7 +130,7 @@ void test_king_moves_generation() {
         });
 
         it("Testing king possible moves on h8", [&]() {
-            Bitboard h8Moves = engine.generateSingleKingAttacksMask(h8);
+            Bitboard h8Moves = generateSingleKingAttacksMask(h8);
             expect(h8Moves.getBit(g8));
             expect(h8Moves.getBit(h7));
             expect(h8Moves.getBit(g7));
@@ -141,7 +138,7 @@ void test_king_moves_generation() {
         });
 
         it("Testing king possible moves on h1", [&]() {
-            Bitboard h1Moves = engine.generateSingleKingAttacksMask(h1);
+            Bitboard h1Moves = generateSingleKingAttacksMask(h1);
             expect(h1Moves.getBit(h2));
             expect(h1Moves.getBit(g2));
             expect(h1Moves.getBit(g1));
@@ -149,7 +146,7 @@ void test_king_moves_generation() {
         });
 
         it("Testing king possible moves on d8", [&]() {
-            Bitboard d8Moves = engine.generateSingleKingAttacksMask(d8);
+            Bitboard d8Moves = generateSingleKingAttacksMask(d8);
             expect(d8Moves.getBit(c8));
             expect(d8Moves.getBit(e8));
             expect(d8Moves.getBit(c7));
@@ -162,11 +159,9 @@ void test_king_moves_generation() {
 
 void test_bishop_relevant_occupancies_moves_generation() {
     describe("Testing bishop relavant occupancies generations", []() {
-        Engine engine;
-
         it("Testing bishop relavant occupancies on e4", [&]() {
             Bitboard bOnE4 =
-                engine.generateSingleBishopRelevantOccupanciesMask(e4);
+                generateSingleBishopRelevantOccupanciesMask(e4);
             expect(bOnE4.getBit(c2));
             expect(bOnE4.getBit(g2));
             expect(bOnE4.getBit(d3));
@@ -181,7 +176,7 @@ void test_bishop_relevant_occupancies_moves_generation() {
 
         it("Testing bishop relavant occupancies on e1", [&]() {
             Bitboard bOnE1 =
-                engine.generateSingleBishopRelevantOccupanciesMask(e1);
+                generateSingleBishopRelevantOccupanciesMask(e1);
             expect(bOnE1.getBit(d2));
             expect(bOnE1.getBit(f2));
             expect(bOnE1.getBit(c3));
@@ -192,7 +187,7 @@ void test_bishop_relevant_occupancies_moves_generation() {
 
         it("Testing bishop relavant occupancies on h7", [&]() {
             Bitboard bOnH7 =
-                engine.generateSingleBishopRelevantOccupanciesMask(h7);
+                generateSingleBishopRelevantOccupanciesMask(h7);
             expect(bOnH7.getBit(g6));
             expect(bOnH7.getBit(f5));
             expect(bOnH7.getBit(e4));
@@ -203,7 +198,7 @@ void test_bishop_relevant_occupancies_moves_generation() {
 
         it("Testing bishop relavant occupancies on a8", [&]() {
             Bitboard bOnA8 =
-                engine.generateSingleBishopRelevantOccupanciesMask(a8);
+                generateSingleBishopRelevantOccupanciesMask(a8);
             expect(bOnA8.getBit(b7));
             expect(bOnA8.getBit(c6));
             expect(bOnA8.getBit(d5));
@@ -217,11 +212,9 @@ void test_bishop_relevant_occupancies_moves_generation() {
 
 void test_rook_relevant_occupancies_moves_generation() {
     describe("Testing rook relavant occupancies generations", []() {
-        Engine engine;
-
         it("Testing rook relavant occupancies on e4", [&]() {
             Bitboard rInE4 =
-                engine.generateSingleRookRelevantOccupanciesMask(e4);
+                generateSingleRookRelevantOccupanciesMask(e4);
             expect(rInE4.getBit(e2));
             expect(rInE4.getBit(e3));
             expect(rInE4.getBit(e5));
@@ -237,7 +230,7 @@ void test_rook_relevant_occupancies_moves_generation() {
 
         it("Testing rook relavant occupancies on a1", [&]() {
             Bitboard rInA1 =
-                engine.generateSingleRookRelevantOccupanciesMask(a1);
+                generateSingleRookRelevantOccupanciesMask(a1);
             expect(rInA1.getBit(a2));
             expect(rInA1.getBit(a3));
             expect(rInA1.getBit(a4));
@@ -255,7 +248,7 @@ void test_rook_relevant_occupancies_moves_generation() {
 
         it("Testing rook relavant occupancies on h8", [&]() {
             Bitboard rInH8 =
-                engine.generateSingleRookRelevantOccupanciesMask(h8);
+                generateSingleRookRelevantOccupanciesMask(h8);
             expect(rInH8.getBit(h7));
             expect(rInH8.getBit(h6));
             expect(rInH8.getBit(h5));
@@ -273,7 +266,7 @@ void test_rook_relevant_occupancies_moves_generation() {
 
         it("Testing rook relavant occupancies on c1", [&]() {
             Bitboard rInC1 =
-                engine.generateSingleRookRelevantOccupanciesMask(c1);
+                generateSingleRookRelevantOccupanciesMask(c1);
             expect(rInC1.getBit(b1));
             expect(rInC1.getBit(d1));
             expect(rInC1.getBit(e1));
@@ -292,11 +285,10 @@ void test_rook_relevant_occupancies_moves_generation() {
 
 void test_bishop_attacks_generation() {
     describe("Testing bishop attacks generations", []() {
-        Engine engine;
         Bitboard blocks;
 
         it("Testing bishop attacks on e4 with no blockers", [&]() {
-            Bitboard bOnE4 = engine.generateSingleBishopAttacks(e4, blocks);
+            Bitboard bOnE4 = generateSingleBishopAttacks(e4, blocks);
             expect(bOnE4.getBit(b1));
             expect(bOnE4.getBit(h1));
             expect(bOnE4.getBit(c2));
@@ -321,7 +313,7 @@ void test_bishop_attacks_generation() {
             blocks.setBit(g2);
             blocks.setBit(g1);  // not a real blocker
 
-            Bitboard b0nD5 = engine.generateSingleBishopAttacks(d5, blocks);
+            Bitboard b0nD5 = generateSingleBishopAttacks(d5, blocks);
             expect(b0nD5.getBit(c6));
             expect(b0nD5.getBit(b3));
             expect(b0nD5.getBit(c4));
@@ -339,7 +331,7 @@ void test_bishop_attacks_generation() {
             blocks.setBit(b6);
             blocks.setBit(g4);  // not a real blocker
 
-            Bitboard b0nA5 = engine.generateSingleBishopAttacks(a5, blocks);
+            Bitboard b0nA5 = generateSingleBishopAttacks(a5, blocks);
             expect(b0nA5.getBit(b6));
             expect(b0nA5.getBit(b4));
             expect(b0nA5.getBit(c3));
@@ -352,11 +344,10 @@ void test_bishop_attacks_generation() {
 
 void test_rook_attacks_generation() {
     describe("Testing Rook attacks generations", []() {
-        Engine engine;
         Bitboard blocks;
 
         it("Testing Rook attacks on d5 with no blockers", [&]() {
-            Bitboard rOnD5 = engine.generateSingleRookAttacks(d5, blocks);
+            Bitboard rOnD5 = generateSingleRookAttacks(d5, blocks);
             expect(rOnD5.getBit(d1));
             expect(rOnD5.getBit(d2));
             expect(rOnD5.getBit(d3));
@@ -382,7 +373,7 @@ void test_rook_attacks_generation() {
             blocks.setBit(g4);
             blocks.setBit(g1);  // not a real blocker
 
-            Bitboard r0nE4 = engine.generateSingleRookAttacks(e4, blocks);
+            Bitboard r0nE4 = generateSingleRookAttacks(e4, blocks);
             expect(r0nE4.getBit(e3));
             expect(r0nE4.getBit(e5));
             expect(r0nE4.getBit(e6));
@@ -400,7 +391,7 @@ void test_rook_attacks_generation() {
             blocks.setBit(b4);
             blocks.setBit(g2);  // not a real blocker
 
-            Bitboard r0nB6 = engine.generateSingleRookAttacks(b6, blocks);
+            Bitboard r0nB6 = generateSingleRookAttacks(b6, blocks);
             expect(r0nB6.getBit(b8));
             expect(r0nB6.getBit(b7));
             expect(r0nB6.getBit(b5));
@@ -420,9 +411,6 @@ void test_sliding_pieces_generation() {
     describe("Testing Sliding pieced attacks generations", []() {
         Engine engine;
 
-        engine.generateSliderPiecesAttacks(IS_BISHOP);
-        engine.generateSliderPiecesAttacks(IS_ROOK);
-
         describe("Occupancies on: f6, f2, b2, b1, h2, h7, e4", [&]() {
             Bitboard occupancies;
             occupancies.setBit(f6);
@@ -545,6 +533,100 @@ void test_sliding_pieces_generation() {
     });
 }
 
+void test_shared_attack_tables() {
+    describe("Testing shared attack tables", []() {
+        it("Testing every thread gets the same tables", [&]() {
+            const AttackTables* seen[4];
+            std::vector<std::thread> threads;
+            for (int index = 0; index < 4; index++) {
+                threads.emplace_back(
+                    [&seen, index]() { seen[index] = &attackTables(); });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+            for (const AttackTables* tables : seen) {
+                expect(tables == &attackTables());
+            }
+        });
+
+        it("Testing engines do not carry their own copy", [&]() {
+            expect(sizeof(Engine) < sizeof(AttackTables) / 4);
+        });
+
+        it("Testing tables match the generators", [&]() {
+            const AttackTables& tables = attackTables();
+            bool matching = true;
+            for (int index = 0; index < 64; index++) {
+                Square square = static_cast<Square>(index);
+                matching &= tables.knightAttacksMasks[square] ==
+                            generateSingleKnightAttacksMask(square);
+                matching &= tables.kingAttacksMasks[square] ==
+                            generateSingleKingAttacksMask(square);
+                matching &= tables.pawnAttacksMasks[BLACK][square] ==
+                            generateSinglePawnMaskAttacks(square, BLACK);
+            }
+            expect(matching);
+        });
+
+        it("Testing slider tables are packed under 900KB", [&]() {
+            const AttackTables& tables = attackTables();
+            expect(sizeof(tables.sliderAttacks) +
+                       sizeof(tables.bishopMagics) +
+                       sizeof(tables.rookMagics) <
+                   900 * 1024);
+            expect(tables.rookMagics[a1].offset == 0);
+            expect(tables.rookMagics[b1].offset == 4096);
+            expect(tables.bishopMagics[a1].offset == ROOK_ATTACKS_ENTRIES);
+        });
+
+        it("Testing the backend picked at startup", [&]() {
+            expect(attackTables().sliderBackend == defaultSliderBackend());
+            expect(defaultSliderBackend() ==
+                   (isPextSupported() ? PEXT_BACKEND : MAGIC_BACKEND));
+        });
+
+        std::vector<std::pair<std::string, SliderBackend>> backends = {
+            {"magic", MAGIC_BACKEND}};
+        if (isPextSupported()) {
+            backends.push_back({"PEXT", PEXT_BACKEND});
+        }
+
+        for (auto [name, backend] : backends) {
+            it("Testing " + name + " slider lookups match the generators",
+               [backend = backend]() {
+                   auto tables = buildAttackTables(backend);
+                   bool matching = true;
+                   for (int index = 0; index < 64; index++) {
+                       Square square = static_cast<Square>(index);
+                       Bitboard bishopMask = tables->bishopMagics[square].mask;
+                       Bitboard rookMask = tables->rookMagics[square].mask;
+                       for (int subset = 0; subset < 512; subset++) {
+                           Bitboard blocks = setOccupancy(subset, bishopMask);
+                           matching &=
+                               bishopAttacks(*tables, square, blocks) ==
+                               generateSingleBishopAttacks(square, blocks);
+                           blocks = setOccupancy(subset * 7, rookMask);
+                           matching &=
+                               rookAttacks(*tables, square, blocks) ==
+                               generateSingleRookAttacks(square, blocks);
+                       }
+                   }
+                   expect(matching);
+               });
+        }
+
+        it("Testing between masks", [&]() {
+            const AttackTables& tables = attackTables();
+            expect(tables.betweenMasks[a1][h8].popCount() == 6);
+            expect(tables.betweenMasks[h8][a1] == tables.betweenMasks[a1][h8]);
+            expect(tables.betweenMasks[e1][e8].popCount() == 6);
+            expect(tables.betweenMasks[e1][e2].isEmpty());
+            expect(tables.betweenMasks[a1][b3].isEmpty());
+        });
+    });
+}
+
 void test_square_under_attacks() {
     describe("Testing Square under attacks", []() {
         Engine engine;
@@ -1823,6 +1905,324 @@ void test_evaluate_position() {
     });
 }
 
+struct PerftPosition {
+    std::string fen;
+    int depth;
+    long long int nodes;
+    long long int nodesNextDepth;
+};
+
+const std::vector<PerftPosition> perftPositions = {
+    {"rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 3, 8902,
+     197281},
+    {"r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 2,
+     2039, 97862},
+    {"8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 3, 2812, 43238},
+    {"r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1", 2,
+     264, 9467},
+    {"rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8", 2, 1486,
+     62379},
+};
+
+void test_perft() {
+    describe("Testing perft", [&]() {
+        Engine engine;
+        engine.init();
+
+        for (UndoMode mode : {UNDO_INCREMENTAL, UNDO_SNAPSHOT}) {
+            std::string modeName =
+                mode == UNDO_SNAPSHOT ? "snapshot" : "incremental";
+
+            for (const auto& position : perftPositions) {
+                it("Testing " + position.fen + " depth " +
+                       std::to_string(position.depth) + " (" + modeName +
+                       " undo)",
+                   [&]() {
+                       engine.board.undoMode = mode;
+                       engine.parseFEN(position.fen);
+                       expect(engine.perftDriver(position.depth) ==
+                              position.nodes);
+                       expect(engine.board.moveHistory.empty());
+                   });
+            }
+        }
+
+        for (const auto& position : perftPositions) {
+            it("Testing hash keys along " + position.fen, [&]() {
+                engine.board.undoMode = UNDO_INCREMENTAL;
+                engine.verifyHashKeys = true;
+                engine.hashKeyMismatches = 0;
+                engine.parseFEN(position.fen);
+                engine.perftDriver(position.depth);
+                engine.verifyHashKeys = false;
+                expect(engine.hashKeyMismatches == 0);
+            });
+        }
+    });
+}
+
+void test_parallel_perft() {
+    describe("Testing parallel perft", [&]() {
+        Engine engine;
+        engine.init();
+
+        for (const auto& position : perftPositions) {
+            it("Testing divide of " + position.fen, [&]() {
+                engine.parseFEN(position.fen);
+                engine.perftThreads = 1;
+                auto serial = engine.perftDivide(position.depth);
+
+                for (int splitDepth : {1, 2, 3}) {
+                    engine.perftThreads = 3;
+                    engine.perftSplitDepth = splitDepth;
+                    auto parallel = engine.perftDivide(position.depth);
+
+                    expect(parallel.size() == serial.size());
+                    long long int nodes = 0;
+                    for (size_t index = 0; index < parallel.size(); index++) {
+                        expect(parallel[index].first == serial[index].first);
+                        expect(parallel[index].second == serial[index].second);
+                        nodes += parallel[index].second;
+                    }
+                    expect(nodes == position.nodes);
+                }
+                expect(engine.board.moveHistory.empty());
+            });
+        }
+
+        it("Testing hash keys are verified by the workers", [&]() {
+            engine.verifyHashKeys = true;
+            engine.hashKeyMismatches = 0;
+            engine.perftThreads = 2;
+            engine.perftSplitDepth = 1;
+            engine.parseFEN(perftPositions[1].fen);
+            engine.perftDivide(perftPositions[1].depth);
+            engine.verifyHashKeys = false;
+            expect(engine.hashKeyMismatches == 0);
+        });
+    });
+}
+
+void test_hashed_perft() {
+    describe("Testing hashed perft", [&]() {
+        it("Testing table store and probe", [&]() {
+            PerftTable table(1);
+            long long int nodes = 0;
+
+            expect(!table.probe(0xabcdef, 3, nodes));
+            table.store(0xabcdef, 3, 8902);
+            expect(table.probe(0xabcdef, 3, nodes) && nodes == 8902);
+            expect(!table.probe(0xabcdef, 4, nodes));
+            expect(!table.probe(0xabcdee, 3, nodes));
+
+            table.clear();
+            expect(!table.probe(0xabcdef, 3, nodes));
+        });
+
+        it("Testing the deepest subtree survives in a bucket", [&]() {
+            PerftTable table(1);
+            long long int nodes = 0;
+            uint64_t key = 0x10;
+            uint64_t other = key | (1ULL << 62);
+            uint64_t third = key | (1ULL << 61);
+
+            table.store(key, 5, 500);
+            table.store(other, 2, 20);
+            table.store(third, 3, 30);
+            expect(table.probe(key, 5, nodes) && nodes == 500);
+            expect(table.probe(third, 3, nodes) && nodes == 30);
+            expect(!table.probe(other, 2, nodes));
+        });
+
+        Engine engine;
+        engine.init();
+
+        for (int threads : {1, 3}) {
+            for (const auto& position : perftPositions) {
+                it("Testing " + position.fen + " with " +
+                       std::to_string(threads) + " thread(s)",
+                   [&]() {
+                       engine.perftTable = std::make_shared<PerftTable>(1);
+                       engine.perftThreads = threads;
+                       engine.perftSplitDepth = 1;
+                       engine.parseFEN(position.fen);
+
+                       // The second run is answered from the table
+                       for (int run = 0; run < 2; run++) {
+                           long long int nodes = 0;
+                           for (const auto& [move, count] :
+                                engine.perftDivide(position.depth + 1)) {
+                               nodes += count;
+                           }
+                           expect(nodes == position.nodesNextDepth);
+                       }
+                       engine.perftTable = nullptr;
+                   });
+            }
+        }
+    });
+}
+
+std::vector<std::string> legalMovesOf(Engine& engine) {
+    std::vector<std::string> moves;
+    for (u_int32_t move : engine.generateLegalMoves()) {
+        moves.push_back(Move(move).toStringUCI());
+    }
+    std::sort(moves.begin(), moves.end());
+    return moves;
+}
+
+std::vector<std::string> filteredPseudoLegalMovesOf(Engine& engine) {
+    std::vector<std::string> moves;
+    for (u_int32_t move : engine.generateAllPseudoLegalMoves()) {
+        if (engine.makeMove(Move(move))) {
+            engine.undoMove();
+            moves.push_back(Move(move).toStringUCI());
+        }
+    }
+    std::sort(moves.begin(), moves.end());
+    return moves;
+}
+
+void test_legal_move_generation() {
+    describe("Testing legal move generation", [&]() {
+        Engine engine;
+        engine.init();
+
+        for (const auto& position : perftPositions) {
+            it("Testing legal moves match filtered pseudo legal moves two "
+               "plies from " + position.fen,
+               [&]() {
+                   engine.parseFEN(position.fen);
+                   bool same = legalMovesOf(engine) ==
+                               filteredPseudoLegalMovesOf(engine);
+
+                   for (u_int32_t move : engine.generateLegalMoves()) {
+                       engine.board.makePsuedoLegalMove(Move(move));
+                       same = same && legalMovesOf(engine) ==
+                                          filteredPseudoLegalMovesOf(engine);
+                       engine.undoMove();
+                   }
+                   expect(same);
+               });
+        }
+
+        for (MoveGenerationMode mode :
+             {GENERATE_LEGAL, GENERATE_PSEUDO_LEGAL}) {
+            for (const auto& position : perftPositions) {
+                it("Testing " + position.fen + " depth " +
+                       std::to_string(position.depth + 1) + " (" +
+                       (mode == GENERATE_LEGAL ? "legal" : "pseudo legal") +
+                       ")",
+                   [&]() {
+                       engine.generationMode = mode;
+                       engine.parseFEN(position.fen);
+                       expect(engine.perftDriver(position.depth + 1) ==
+                              position.nodesNextDepth);
+                       expect(engine.board.moveHistory.empty());
+                   });
+            }
+        }
+        engine.generationMode = GENERATE_LEGAL;
+
+        it("Testing en passant exposing the king is illegal", [&]() {
+            engine.parseFEN("8/8/8/K2pP2r/8/8/8/7k w - d6 0 1");
+            auto moves = legalMovesOf(engine);
+            expect(std::find(moves.begin(), moves.end(), "e5d6") ==
+                   moves.end());
+            expect(moves == filteredPseudoLegalMovesOf(engine));
+        });
+
+        it("Testing en passant capturing the checker is legal", [&]() {
+            engine.parseFEN("8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1");
+            auto moves = legalMovesOf(engine);
+            expect(std::find(moves.begin(), moves.end(), "e4d3") !=
+                   moves.end());
+            expect(moves == filteredPseudoLegalMovesOf(engine));
+        });
+
+        it("Testing a pinned knight cannot move", [&]() {
+            engine.parseFEN("4r1k1/8/8/8/8/8/4N3/4K3 w - - 0 1");
+            auto moves = legalMovesOf(engine);
+            expect(moves.size() == 4);
+            expect(moves == filteredPseudoLegalMovesOf(engine));
+        });
+
+        it("Testing a pinned rook slides along the pin", [&]() {
+            engine.parseFEN("4r1k1/8/8/8/8/4R3/8/4K3 w - - 0 1");
+            auto moves = legalMovesOf(engine);
+            expect(std::find(moves.begin(), moves.end(), "e3e8") !=
+                   moves.end());
+            expect(std::find(moves.begin(), moves.end(), "e3d3") ==
+                   moves.end());
+            expect(moves == filteredPseudoLegalMovesOf(engine));
+        });
+
+        it("Testing only the king moves in double check", [&]() {
+            engine.parseFEN("4r1k1/8/8/8/8/5n2/3B4/4K3 w - - 0 1");
+            bool onlyKing = true;
+            for (u_int32_t move : engine.generateLegalMoves()) {
+                onlyKing = onlyKing && Move(move).piece == KING;
+            }
+            expect(onlyKing);
+            expect(legalMovesOf(engine) == filteredPseudoLegalMovesOf(engine));
+        });
+
+        it("Testing the king cannot step back along a checking ray", [&]() {
+            engine.parseFEN("4r1k1/8/8/8/8/8/8/4K3 w - - 0 1");
+            auto moves = legalMovesOf(engine);
+            expect(std::find(moves.begin(), moves.end(), "e1e2") ==
+                   moves.end());
+            expect(moves == filteredPseudoLegalMovesOf(engine));
+        });
+    });
+}
+
+std::vector<uint32_t> sortedPawnMoves(Engine& engine, bool perSquare) {
+    MoveList moves;
+    if (perSquare) {
+        engine.generatePawnMovesPerSquare(moves);
+    } else {
+        engine.generatePawnMoves(moves);
+    }
+    std::vector<uint32_t> sorted(moves.begin(), moves.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+void test_setwise_pawn_moves() {
+    describe("Testing set-wise pawn moves", [&]() {
+        Engine engine;
+        engine.init();
+
+        std::vector<std::string> fens = {
+            "8/8/8/K2pP2r/8/8/8/7k w - d6 0 1",
+            "8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1",
+            "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+            "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N w - - 0 1",
+        };
+        for (const auto& position : perftPositions) {
+            fens.push_back(position.fen);
+        }
+
+        for (const auto& fen : fens) {
+            it("Testing the per-square moves two plies from " + fen, [&]() {
+                engine.parseFEN(fen);
+                bool same = sortedPawnMoves(engine, false) ==
+                            sortedPawnMoves(engine, true);
+
+                for (u_int32_t move : engine.generateLegalMoves()) {
+                    engine.board.makePsuedoLegalMove(Move(move));
+                    same = same && sortedPawnMoves(engine, false) ==
+                                       sortedPawnMoves(engine, true);
+                    engine.undoMove();
+                }
+                expect(same);
+            });
+        }
+    });
+}
+
 void run_engine_tests() {
     describe("Testing engine", []() {
         test_pawn_attacks_generation();
@@ -1836,6 +2236,7 @@ void run_engine_tests() {
         test_rook_attacks_generation();
 
         test_sliding_pieces_generation();
+        test_shared_attack_tables();
         test_square_under_attacks();
 
         test_move_generations();
@@ -1844,5 +2245,10 @@ void run_engine_tests() {
         test_parse_uci_position();
 
         test_evaluate_position();
+        test_perft();
+        test_parallel_perft();
+        test_hashed_perft();
+        test_legal_move_generation();
+        test_setwise_pawn_moves();
     });
 }
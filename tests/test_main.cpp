@@ -8,6 +8,9 @@ void run_bitboard_tests();
 void run_chessboard_tests();
 void run_engine_tests();
 void run_move_tests();
+void run_move_list_tests();
+void run_search_tests();
+void run_thread_pool_tests();
 
 int main() {
     logger.configure(LoggerProps{enabled : false});
@@ -16,7 +19,10 @@ int main() {
         run_bitboard_tests();
         run_chessboard_tests();
         run_move_tests();
+        run_move_list_tests();
+        run_thread_pool_tests();
         run_engine_tests();
+        run_search_tests();
     });
     return 0;
 }
\ No newline at end of file
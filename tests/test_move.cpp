@@ -275,6 +275,28 @@ void run_move_tests() {
                     expect(original == decoded);
                 }
             });
+
+            it("Testing every move type decodes back on every file", []() {
+                bool roundTrip = true;
+                for (int type = PAWN_PUSH; type <= KING_CAPTURE; type++) {
+                    // Castling targets the c or g file only
+                    if (type == CASTLE_KINGSIDE || type == CASTLE_QUEENSIDE) {
+                        Square to = type == CASTLE_KINGSIDE ? g8 : c8;
+                        Move move(e8, to, static_cast<MoveType>(type));
+                        roundTrip = roundTrip && move.type == type;
+                        continue;
+                    }
+                    for (int to = a1; to <= h8; to++) {
+                        u_int32_t binary =
+                            Move::createBinary(e4, static_cast<Square>(to),
+                                               static_cast<MoveType>(type));
+                        Move decoded(binary);
+                        roundTrip = roundTrip && decoded.type == type &&
+                                    decoded.toBinary() == binary;
+                    }
+                }
+                expect(roundTrip);
+            });
         });
 
         describe("Testing toString method", []() {
@@ -0,0 +1,113 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "../src/engine/engine.h"
+#include "../src/engine/move/move-list.h"
+#include "test_lib.h"
+
+// Counts every heap allocation made by the test binary
+std::atomic<long long int> allocationsCount{0};
+
+void* operator new(std::size_t size) {
+    allocationsCount++;
+    if (void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void run_move_list_tests() {
+    describe("Testing move list", []() {
+        it("Testing push, index and iteration", []() {
+            MoveList moves;
+            expect(moves.empty());
+
+            moves.push_back(10);
+            moves.push_back(20);
+            moves.push_back(30);
+            expect(moves.size() == 3);
+            expect(moves[1] == 20);
+
+            uint32_t sum = 0;
+            for (uint32_t move : moves) {
+                sum += move;
+            }
+            expect(sum == 60);
+
+            moves.clear();
+            expect(moves.empty());
+        });
+
+        it("Testing scores follow their move on swap", []() {
+            MoveList moves;
+            moves.push_back(10);
+            moves.push_back(20);
+            moves.setScore(0, -5);
+            moves.setScore(1, 7);
+
+            moves.swap(0, 1);
+            expect(moves[0] == 20 && moves.score(0) == 7);
+            expect(moves[1] == 10 && moves.score(1) == -5);
+        });
+
+        it("Testing a new move starts with a zero score", []() {
+            MoveList moves;
+            moves.push_back(10);
+            moves.setScore(0, 99);
+            moves.clear();
+            moves.push_back(20);
+            expect(moves.score(0) == 0);
+        });
+
+        describe("Testing no heap allocation per node", []() {
+            Engine engine;
+            engine.init();
+            std::string fen =
+                "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w "
+                "KQkq - 0 1";
+
+            it("Testing move generation", [&]() {
+                engine.parseFEN(fen);
+                long long int before = allocationsCount;
+                MoveList moves = engine.generateAllPseudoLegalMoves();
+                long long int allocations = allocationsCount - before;
+
+                // expect() itself allocates its message, compare afterwards
+                expect(allocations == 0);
+                expect(moves.size() == 48);
+            });
+
+            for (UndoMode mode : {UNDO_INCREMENTAL, UNDO_SNAPSHOT}) {
+                it(std::string("Testing perft with ") +
+                       (mode == UNDO_SNAPSHOT ? "snapshot" : "incremental") +
+                       " undo",
+                   [&]() {
+                       engine.board.undoMode = mode;
+                       engine.parseFEN(fen);
+                       long long int before = allocationsCount;
+                       long long int nodes = engine.perftDriver(3);
+                       long long int allocations = allocationsCount - before;
+
+                       expect(nodes == 97862);
+                       expect(allocations == 0);
+                   });
+            }
+
+            it("Testing search", [&]() {
+                engine.board.undoMode = UNDO_INCREMENTAL;
+                engine.parseFEN(fen);
+                long long int before = allocationsCount;
+                engine.searchBestMove(3);
+                long long int allocations = allocationsCount - before;
+
+                expect(allocations == 0);
+            });
+        });
+    });
+}
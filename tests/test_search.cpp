@@ -0,0 +1,809 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+#include "../src/engine/engine.h"
+#include "../src/engine/search/score.h"
+#include "../src/engine/search/time-manager.h"
+#include "../src/engine/search/transposition-table.h"
+#include "test_lib.h"
+
+void test_transposition_table() {
+    describe("Testing transposition table", [&]() {
+        it("Testing size is a power of two of full buckets", [&]() {
+            TranspositionTable table(1);
+            size_t entries = table.entriesCount();
+            expect(entries > 0);
+            expect((entries & (entries - 1)) == 0);
+            expect(entries * 16 <= 1024 * 1024);
+        });
+
+        it("Testing store and probe", [&]() {
+            TranspositionTable table(1);
+            TranspositionEntry entry;
+            expect(!table.probe(0x1234567890abcdefULL, entry));
+
+            table.store(0x1234567890abcdefULL, 0xabcdef, -321, 7,
+                        BOUND_EXACT);
+            expect(table.probe(0x1234567890abcdefULL, entry));
+            expect(entry.move == 0xabcdef);
+            expect(entry.score == -321);
+            expect(entry.depth == 7);
+            expect(entry.bound == BOUND_EXACT);
+        });
+
+        it("Testing mate scores survive packing", [&]() {
+            TranspositionTable table(1);
+            TranspositionEntry entry;
+
+            table.store(1, 0, MATE_SCORE - 3, 1, BOUND_LOWER);
+            table.store(2, 0, -MATE_SCORE + 4, 1, BOUND_UPPER);
+            expect(table.probe(1, entry) && entry.score == MATE_SCORE - 3);
+            expect(table.probe(2, entry) && entry.score == -MATE_SCORE + 4);
+        });
+
+        it("Testing a different key in the same bucket misses", [&]() {
+            TranspositionTable table(1);
+            TranspositionEntry entry;
+            uint64_t key = 0x00000000000000ffULL;
+            uint64_t sameBucket = key | (1ULL << 63);
+
+            table.store(key, 1, 10, 3, BOUND_EXACT);
+            expect(!table.probe(sameBucket, entry));
+        });
+
+        it("Testing same key keeps the best move when none given", [&]() {
+            TranspositionTable table(1);
+            TranspositionEntry entry;
+
+            table.store(42, 0x1234, 10, 3, BOUND_EXACT);
+            table.store(42, 0, 5, 4, BOUND_UPPER);
+            expect(table.probe(42, entry));
+            expect(entry.move == 0x1234);
+            expect(entry.depth == 4);
+            expect(entry.bound == BOUND_UPPER);
+        });
+
+        it("Testing the shallowest entry is replaced in a full bucket", [&]() {
+            TranspositionTable table(1);
+            TranspositionEntry entry;
+            uint64_t bucket = 5;
+
+            for (uint64_t index = 1; index <= 4; index++) {
+                table.store(bucket | (index << 60), 0, 0, (int)index * 2,
+                            BOUND_EXACT);
+            }
+            table.store(bucket | (5ULL << 60), 0, 0, 9, BOUND_EXACT);
+
+            expect(!table.probe(bucket | (1ULL << 60), entry));
+            expect(table.probe(bucket | (4ULL << 60), entry));
+            expect(table.probe(bucket | (5ULL << 60), entry));
+        });
+
+        it("Testing clear", [&]() {
+            TranspositionTable table(1);
+            TranspositionEntry entry;
+
+            table.store(42, 0x1234, 10, 3, BOUND_EXACT);
+            expect(table.hashfull() >= 0);
+            table.clear();
+            expect(!table.probe(42, entry));
+        });
+    });
+}
+
+void test_search_with_transposition_table() {
+    describe("Testing search with transposition table", [&]() {
+        Engine engine;
+        engine.init();
+
+        it("Testing setoption Hash resizes the table", [&]() {
+            expect(engine.parseUCISetOption("setoption name Hash value 2"));
+            expect(engine.transpositionTable->entriesCount() ==
+                   2 * TranspositionTable(1).entriesCount());
+            expect(!engine.parseUCISetOption("setoption name Hash value 0"));
+        });
+
+        it("Testing mate in one is found", [&]() {
+            engine.parseFEN("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+            auto result = engine.searchBestMove(3);
+            expect(result.first.toStringUCI() == "a1a8");
+            expect(result.second > MATE_BOUND);
+        });
+
+        it("Testing the same score with and without the table", [&]() {
+            std::string fen =
+                "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w "
+                "KQkq - 0 1";
+
+            // Pruning decisions depend on the move order, exact search only
+            engine.useNullMovePruning = false;
+            engine.useLateMoveReductions = false;
+            engine.transpositionTable->clear();
+            engine.parseFEN(fen);
+            int hashedScore = engine.searchBestMove(3).second;
+
+            auto table = engine.transpositionTable;
+            engine.transpositionTable = nullptr;
+            engine.parseFEN(fen);
+            int plainScore = engine.searchBestMove(3).second;
+            engine.transpositionTable = table;
+            engine.useNullMovePruning = true;
+            engine.useLateMoveReductions = true;
+
+            expect(hashedScore == plainScore);
+        });
+    });
+}
+
+void test_time_manager() {
+    describe("Testing time manager", [&]() {
+        TimeManager timeManager;
+
+        it("Testing depth only search has no limits", [&]() {
+            SearchLimits limits;
+            limits.depth = 5;
+            timeManager.start(limits, WHITE);
+            expect(timeManager.softLimit() == -1);
+            expect(timeManager.hardLimit() == -1);
+            expect(!timeManager.hardLimitReached());
+        });
+
+        it("Testing infinite search has no limits", [&]() {
+            SearchLimits limits;
+            limits.infinite = true;
+            limits.wtime = 1000;
+            timeManager.start(limits, WHITE);
+            expect(timeManager.hardLimit() == -1);
+        });
+
+        it("Testing movetime", [&]() {
+            SearchLimits limits;
+            limits.movetime = 1000;
+            timeManager.start(limits, BLACK);
+            expect(timeManager.softLimit() == 1000 - MOVE_OVERHEAD_MS);
+            expect(timeManager.hardLimit() == 1000 - MOVE_OVERHEAD_MS);
+        });
+
+        it("Testing clock uses the side to move", [&]() {
+            SearchLimits limits;
+            limits.wtime = 60000;
+            limits.btime = 1000;
+            timeManager.start(limits, WHITE);
+            int64_t whiteSoft = timeManager.softLimit();
+            timeManager.start(limits, BLACK);
+            expect(whiteSoft > timeManager.softLimit());
+        });
+
+        it("Testing soft limit is below hard limit", [&]() {
+            SearchLimits limits;
+            limits.wtime = 60000;
+            limits.winc = 1000;
+            timeManager.start(limits, WHITE);
+            expect(timeManager.softLimit() > 0);
+            expect(timeManager.softLimit() <= timeManager.hardLimit());
+            expect(timeManager.hardLimit() < 60000 / 2);
+        });
+
+        it("Testing movestogo spends more per move", [&]() {
+            SearchLimits limits;
+            limits.wtime = 60000;
+            timeManager.start(limits, WHITE);
+            int64_t defaultSoft = timeManager.softLimit();
+            limits.movestogo = 5;
+            timeManager.start(limits, WHITE);
+            expect(timeManager.softLimit() > defaultSoft);
+        });
+
+        it("Testing huge increment never exceeds the clock", [&]() {
+            SearchLimits limits;
+            limits.wtime = 100;
+            limits.winc = 10000;
+            limits.movestogo = 1;
+            timeManager.start(limits, WHITE);
+            expect(timeManager.hardLimit() <= 100 - MOVE_OVERHEAD_MS);
+            expect(timeManager.softLimit() >= 1);
+        });
+    });
+}
+
+void test_iterative_deepening() {
+    describe("Testing iterative deepening", [&]() {
+        Engine engine;
+        engine.init();
+
+        it("Testing depth limit", [&]() {
+            engine.setupInitialPosition();
+            SearchLimits limits;
+            limits.depth = 3;
+            auto result = engine.search(limits);
+            expect(engine.nodes > 0);
+            expect(engine.signals->nodes == engine.nodes);
+            expect(!engine.isStopped());
+            expect(result.first.from != result.first.to);
+        });
+
+        it("Testing movetime aborts and returns a legal move", [&]() {
+            engine.parseFEN(
+                "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w "
+                "KQkq - 0 1");
+            SearchLimits limits;
+            limits.movetime = 100;
+            engine.signals->stop = false;
+
+            using namespace std::chrono;
+            auto start = steady_clock::now();
+            auto result = engine.search(limits);
+            auto elapsed =
+                duration_cast<milliseconds>(steady_clock::now() - start)
+                    .count();
+
+            expect(elapsed < 1000);
+            expect(engine.board.moveHistory.empty());
+            expect(engine.makeMove(result.first));
+            engine.undoMove();
+        });
+    });
+}
+
+void test_search_signals() {
+    describe("Testing search signals", [&]() {
+        Engine engine;
+        engine.init();
+        std::string fen =
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq "
+            "- 0 1";
+
+        it("Testing stop ends an infinite search", [&]() {
+            engine.parseFEN(fen);
+            engine.signals->stop = false;
+            SearchLimits limits;
+            limits.infinite = true;
+
+            std::pair<Move, int> result = {Move(0), 0};
+            std::thread searchThread([&]() { result = engine.search(limits); });
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            engine.signals->stop = true;
+            searchThread.join();
+
+            expect(engine.isStopped());
+            expect(engine.board.moveHistory.empty());
+            expect(engine.makeMove(result.first));
+            engine.undoMove();
+        });
+
+        it("Testing ponder ignores the clock until ponderhit", [&]() {
+            engine.parseFEN(fen);
+            engine.signals->stop = false;
+            engine.signals->ponder = true;
+            SearchLimits limits;
+            limits.movetime = 40;
+            limits.ponder = true;
+
+            std::atomic<bool> done{false};
+            std::pair<Move, int> result = {Move(0), 0};
+            std::thread searchThread([&]() {
+                result = engine.search(limits);
+                done = true;
+            });
+            std::this_thread::sleep_for(std::chrono::milliseconds(150));
+            expect(!done);
+
+            engine.signals->ponder = false;
+            searchThread.join();
+            expect(done);
+            expect(engine.makeMove(result.first));
+            engine.undoMove();
+        });
+    });
+}
+
+void test_lazy_smp() {
+    describe("Testing Lazy SMP", [&]() {
+        Engine engine;
+        engine.init();
+
+        it("Testing setoption Threads", [&]() {
+            expect(engine.parseUCISetOption("setoption name Threads value 4"));
+            expect(engine.threadsCount == 4);
+            expect(!engine.parseUCISetOption("setoption name Threads value 0"));
+            expect(engine.threadsCount == 4);
+        });
+
+        it("Testing mate in one is found with helpers", [&]() {
+            engine.parseFEN("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+            auto result = engine.searchBestMove(4);
+            expect(result.first.toStringUCI() == "a1a8");
+            expect(result.second > MATE_BOUND);
+        });
+
+        it("Testing helpers add up their nodes", [&]() {
+            engine.parseFEN(
+                "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w "
+                "KQkq - 0 1");
+            engine.signals->stop = false;
+            SearchLimits limits;
+            limits.movetime = 100;
+            auto result = engine.search(limits);
+
+            expect(engine.signals->nodes > engine.nodes);
+            expect(engine.board.moveHistory.empty());
+            expect(engine.makeMove(result.first));
+            engine.undoMove();
+        });
+    });
+}
+
+std::vector<uint32_t> pickAllMoves(Engine& engine, uint32_t hashMove) {
+    Engine::MovePicker picker;
+    engine.initMovePicker(picker, hashMove, 0);
+    std::vector<uint32_t> moves;
+    while (uint32_t move = engine.nextMove(picker)) {
+        moves.push_back(move);
+    }
+    return moves;
+}
+
+bool isCaptureStageMove(uint32_t move) {
+    Move decoded(move);
+    return decoded.isCapture || decoded.promoted != EMPTY;
+}
+
+void test_move_picker() {
+    describe("Testing staged move picker", [&]() {
+        Engine engine;
+        engine.init();
+        std::vector<std::string> fens = {
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq "
+            "- 0 1",
+            "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+            "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+            "8/8/8/2k5/3Pp3/8/8/4K3 b - d3 0 1",
+        };
+
+        for (MoveGenerationMode mode :
+             {GENERATE_LEGAL, GENERATE_PSEUDO_LEGAL}) {
+            for (const auto& fen : fens) {
+                it("Testing captures and quiets split all the moves of " + fen,
+                   [&]() {
+                       engine.generationMode = mode;
+                       engine.parseFEN(fen);
+                       MoveList all = engine.generateMoves();
+                       std::vector<uint32_t> split;
+                       bool partitioned = true;
+
+                       for (GeneratedMoves type :
+                            {CAPTURE_MOVES, QUIET_MOVES}) {
+                           MoveList moves =
+                               mode == GENERATE_LEGAL
+                                   ? engine.generateLegalMoves(type)
+                                   : engine.generateAllPseudoLegalMoves(type);
+                           for (uint32_t move : moves) {
+                               partitioned =
+                                   partitioned && isCaptureStageMove(move) ==
+                                                      (type == CAPTURE_MOVES);
+                               split.push_back(move);
+                           }
+                       }
+
+                       std::vector<uint32_t> expected(all.begin(), all.end());
+                       std::sort(expected.begin(), expected.end());
+                       std::sort(split.begin(), split.end());
+                       expect(partitioned);
+                       expect(split == expected);
+                   });
+
+                it("Testing the picker yields every move once from " + fen,
+                   [&]() {
+                       engine.generationMode = mode;
+                       engine.parseFEN(fen);
+                       MoveList all = engine.generateMoves();
+                       uint32_t hashMove = all[all.size() - 1];
+                       std::vector<uint32_t> picked =
+                           pickAllMoves(engine, hashMove);
+
+                       expect(picked.front() == hashMove);
+                       std::vector<uint32_t> expected(all.begin(), all.end());
+                       std::sort(expected.begin(), expected.end());
+                       std::sort(picked.begin(), picked.end());
+                       expect(picked == expected);
+                   });
+            }
+        }
+        engine.generationMode = GENERATE_LEGAL;
+
+        it("Testing winning captures come first and losing ones last", [&]() {
+            engine.parseFEN(fens[0]);
+            uint32_t firstKiller = Move::createBinary(a2, a3, PAWN_PUSH);
+            uint32_t secondKiller = Move::createBinary(e1, g1, CASTLE_KINGSIDE);
+            engine.killers[0][0] = firstKiller;
+            engine.killers[0][1] = secondKiller;
+
+            std::vector<uint32_t> picked = pickAllMoves(engine, 0);
+            size_t quiets = std::find_if(picked.begin(), picked.end(),
+                                         [](uint32_t move) {
+                                             return !isCaptureStageMove(move);
+                                         }) -
+                            picked.begin();
+            size_t badCaptures =
+                std::find_if(picked.begin() + quiets, picked.end(),
+                             isCaptureStageMove) -
+                picked.begin();
+            bool winningFirst =
+                std::all_of(picked.begin(), picked.begin() + quiets,
+                            [&](uint32_t move) { return engine.see(move); });
+            bool quietsBetween = std::none_of(picked.begin() + quiets,
+                                              picked.begin() + badCaptures,
+                                              isCaptureStageMove);
+            bool losingLast =
+                std::none_of(picked.begin() + badCaptures, picked.end(),
+                             [&](uint32_t move) { return engine.see(move); });
+
+            expect(winningFirst && quietsBetween && losingLast);
+            expect(badCaptures < picked.size());
+            expect(picked[quiets] == firstKiller);
+            expect(picked[quiets + 1] == secondKiller);
+            engine.killers[0][0] = engine.killers[0][1] = 0;
+        });
+
+        it("Testing captures are ordered by MVV-LVA, losing ones last", [&]() {
+            engine.parseFEN("4k3/8/8/3q4/2P1p3/3Q4/8/4K3 w - - 0 1");
+            std::vector<uint32_t> picked = pickAllMoves(engine, 0);
+            expect(Move(picked[0]).toStringUCI() == "c4d5");
+            expect(Move(picked[1]).toStringUCI() == "d3d5");
+            expect(Move(picked.back()).toStringUCI() == "d3e4");
+        });
+
+        it("Testing a hash move from another position is skipped", [&]() {
+            engine.parseFEN(fens[0]);
+            std::vector<uint32_t> plain = pickAllMoves(engine, 0);
+            std::vector<uint32_t> invalid = {
+                Move::createBinary(e7, e5, PAWN_DOUBLE_PUSH),
+                Move::createBinary(d5, e6, PAWN_PUSH),
+                Move::createBinary(e8, g8, CASTLE_KINGSIDE),
+                Move::createBinary(a1, a8, ROOK_QUIET),
+                Move::createBinary(d5, d6, PAWN_CAPTURE_ENPASSANT),
+            };
+            bool skipped = true;
+            for (uint32_t move : invalid) {
+                skipped = skipped && pickAllMoves(engine, move) == plain;
+            }
+            expect(skipped);
+        });
+
+        it("Testing killers are tried before generating the quiets", [&]() {
+            engine.parseFEN(fens[0]);
+            uint32_t hashMove = Move::createBinary(a2, a3, PAWN_PUSH);
+            uint32_t killer = Move::createBinary(e1, g1, CASTLE_KINGSIDE);
+            engine.killers[0][0] = hashMove;
+            engine.killers[0][1] = killer;
+
+            Engine::MovePicker picker;
+            engine.initMovePicker(picker, hashMove, 0);
+            uint32_t move = engine.nextMove(picker);
+            while (move && move != killer) {
+                expect(move == hashMove || isCaptureStageMove(move));
+                move = engine.nextMove(picker);
+            }
+            expect(move == killer);
+            bool quietsGenerated = std::any_of(
+                picker.moves.begin(), picker.moves.end(),
+                [](uint32_t move) { return !isCaptureStageMove(move); });
+            expect(!quietsGenerated);
+
+            std::vector<uint32_t> rest;
+            while (uint32_t move = engine.nextMove(picker)) {
+                rest.push_back(move);
+            }
+            expect(std::count(rest.begin(), rest.end(), hashMove) == 0);
+            expect(std::count(rest.begin(), rest.end(), killer) == 0);
+            engine.killers[0][0] = engine.killers[0][1] = 0;
+        });
+
+        it("Testing killers not playable here are skipped", [&]() {
+            engine.parseFEN(fens[0]);
+            std::vector<uint32_t> plain = pickAllMoves(engine, 0);
+            // A pawn push into a piece and a rook move through a pawn
+            engine.killers[0][0] = Move::createBinary(e4, e5, PAWN_PUSH);
+            engine.killers[0][1] = Move::createBinary(a1, a8, ROOK_QUIET);
+            expect(pickAllMoves(engine, 0) == plain);
+            engine.killers[0][0] = engine.killers[0][1] = 0;
+        });
+
+        it("Testing killers are stored per ply", [&]() {
+            uint32_t first = Move::createBinary(a2, a3, PAWN_PUSH);
+            uint32_t second = Move::createBinary(b2, b3, PAWN_PUSH);
+            engine.storeKiller(first, 3);
+            engine.storeKiller(first, 3);
+            expect(engine.killers[3][0] == first && engine.killers[3][1] == 0);
+            engine.storeKiller(second, 3);
+            expect(engine.killers[3][0] == second &&
+                   engine.killers[3][1] == first);
+        });
+    });
+}
+
+struct SEEPosition {
+    std::string fen;
+    Square from;
+    Square to;
+    MoveType type;
+    int value;  // Material won by the exchange, P=100 N=300 B=350 R=500
+};
+
+void test_static_exchange_evaluation() {
+    describe("Testing static exchange evaluation", [&]() {
+        Engine engine;
+        engine.init();
+        std::vector<SEEPosition> positions = {
+            // Undefended pawn
+            {"1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", e1, e5,
+             ROOK_CAPTURE, 100},
+            // Knight lost for a pawn, the exchange stops when behind
+            {"1k1r3q/1ppn3p/p4b2/4p3/8/P2N2P1/1PP1R1BP/2K1Q3 w - - 0 1", d3,
+             e5, KNIGHT_CAPTURE, -200},
+            // Rook lost for a pawn
+            {"4k3/8/3r4/3p4/8/8/3R4/4K3 w - - 0 1", d2, d5, ROOK_CAPTURE,
+             -400},
+            // The rook behind joins through an x-ray
+            {"3r2k1/8/3p4/8/8/8/3R4/3RK3 w - - 0 1", d2, d6, ROOK_CAPTURE,
+             100},
+            // The queen behind the bishop recaptures too
+            {"4k3/8/8/4p3/3n4/2B5/1Q6/4K3 w - - 0 1", c3, d4,
+             BISHOP_CAPTURE, 50},
+            // Minor pieces recapture before the rook
+            {"3r3k/8/5n2/3p4/8/1BN5/8/7K w - - 0 1", c3, d5,
+             KNIGHT_CAPTURE, -200},
+            // The king can not take a defended piece
+            {"8/8/3k4/3p4/8/8/3R4/3R2K1 w - - 0 1", d2, d5, ROOK_CAPTURE, 100},
+            {"8/8/3k4/3p4/8/8/3R4/6K1 w - - 0 1", d2, d5, ROOK_CAPTURE, -400},
+            {"4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", e5, d6,
+             PAWN_CAPTURE_ENPASSANT, 100},
+            {"1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1", a7, b8,
+             PAWN_CAPTURE_PROMOTION_TO_QUEEN, 1400},
+            // The new queen is taken right away
+            {"1r2k3/P7/8/8/8/8/8/4K3 w - - 0 1", a7, a8,
+             PAWN_PROMOTION_TO_QUEEN, -100},
+            // Quiet move to an attacked square
+            {"4k3/8/8/2p5/8/3N4/8/4K3 w - - 0 1", d3, b4, KNIGHT_QUIET,
+             -300},
+            {"4k3/8/8/8/8/8/8/R3K2R w KQ - 0 1", e1, g1, CASTLE_KINGSIDE, 0},
+        };
+
+        for (const auto& position : positions) {
+            it("Testing the exchange value in " + position.fen, [&]() {
+                engine.parseFEN(position.fen);
+                uint32_t move = Move::createBinary(position.from, position.to,
+                                                   position.type);
+                expect(engine.see(move, position.value));
+                expect(!engine.see(move, position.value + 1));
+            });
+        }
+
+        it("Testing quiescence skips captures losing material", [&]() {
+            engine.parseFEN("4k3/8/8/3q4/2P1p3/3Q4/8/4K3 w - - 0 1");
+            Engine::MovePicker picker;
+            engine.initMovePicker(picker, 0, 0, true);
+            std::vector<std::string> picked;
+            while (uint32_t move = engine.nextMove(picker)) {
+                picked.push_back(Move(move).toStringUCI());
+            }
+            std::vector<std::string> winning = {"c4d5", "d3d5"};
+            expect(picked == winning);
+        });
+    });
+}
+
+void test_quiescence() {
+    describe("Testing quiescence search", [&]() {
+        Engine engine;
+        engine.init();
+
+        it("Testing a defended pawn is not taken with the queen", [&]() {
+            engine.parseFEN("4k3/8/3p4/4p3/8/8/4Q3/4K3 w - - 0 1");
+            auto result = engine.searchBestMove(1);
+            expect(result.first.toStringUCI() != "e2e5");
+            expect(engine.qnodes > 0);
+            expect(engine.qnodes < engine.nodes);
+        });
+
+        it("Testing a hanging queen is taken at depth one", [&]() {
+            engine.parseFEN("4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1");
+            auto result = engine.searchBestMove(1);
+            expect(result.first.toStringUCI() == "d2d5");
+            expect(result.second > 300);
+        });
+
+        it("Testing mate is seen at the horizon", [&]() {
+            engine.parseFEN("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+            auto result = engine.searchBestMove(1);
+            expect(result.first.toStringUCI() == "a1a8");
+            expect(result.second > MATE_BOUND);
+        });
+
+        it("Testing quiescence nodes are published", [&]() {
+            engine.setupInitialPosition();
+            engine.signals->stop = false;
+            SearchLimits limits;
+            limits.depth = 4;
+            engine.search(limits);
+            expect(engine.signals->qnodes == engine.qnodes);
+            expect(engine.signals->qnodes < engine.signals->nodes);
+        });
+    });
+}
+
+void test_history_heuristic() {
+    describe("Testing history heuristic", [&]() {
+        Engine engine;
+        engine.init();
+        engine.setupInitialPosition();
+        uint32_t move = Move::createBinary(g1, f3, KNIGHT_QUIET);
+
+        it("Testing history stays bounded", [&]() {
+            for (int index = 0; index < 1000; index++) {
+                engine.updateHistory(move, 400);
+            }
+            int high = engine.history[WHITE][g1][f3];
+            for (int index = 0; index < 2000; index++) {
+                engine.updateHistory(move, -400);
+            }
+            int low = engine.history[WHITE][g1][f3];
+            expect(high > 0 && high <= 16384);
+            expect(low < 0 && low >= -16384);
+        });
+
+        it("Testing aging halves history", [&]() {
+            engine.history[WHITE][g1][f3] = 1000;
+            engine.ageHistory();
+            expect(engine.history[WHITE][g1][f3] == 500);
+        });
+
+        it("Testing the best history quiet is picked first", [&]() {
+            engine.updateHistory(move, 400);
+            std::vector<uint32_t> picked = pickAllMoves(engine, 0);
+            expect(picked.front() == move);
+        });
+
+        it("Testing cutoffs are counted", [&]() {
+            engine.parseFEN(
+                "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w "
+                "KQkq - 0 1");
+            engine.searchBestMove(4);
+            expect(engine.stats.betaCutoffs > 0);
+            expect(engine.stats.firstMoveCutoffs <= engine.stats.betaCutoffs);
+            expect(engine.stats.firstMoveCutoffRate() > 0.5);
+        });
+    });
+}
+
+void test_principal_variation() {
+    describe("Testing principal variation search", [&]() {
+        Engine engine;
+        engine.init();
+
+        it("Testing the PV is a legal line starting with the best move",
+           [&]() {
+               engine.parseFEN(
+                   "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R "
+                   "w KQkq - 0 1");
+               auto result = engine.searchBestMove(5);
+               std::vector<Move> pv = engine.principalVariation();
+
+               expect(pv.size() >= 2 && pv.size() <= 5);
+               expect(pv.front() == result.first);
+               size_t played = 0;
+               while (played < pv.size() && engine.makeMove(pv[played])) {
+                   played++;
+               }
+               expect(played == pv.size());
+               for (size_t index = 0; index < played; index++) {
+                   engine.undoMove();
+               }
+           });
+
+        it("Testing the PV of a mate ends with the mate", [&]() {
+            engine.parseFEN("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+            engine.searchBestMove(3);
+            std::vector<Move> pv = engine.principalVariation();
+            expect(pv.size() == 1);
+            expect(pv.front().toStringUCI() == "a1a8");
+        });
+
+        it("Testing the same score with and without PV ordering", [&]() {
+            std::string fen =
+                "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq "
+                "- 0 1";
+            auto table = engine.transpositionTable;
+            engine.transpositionTable = nullptr;
+            engine.useNullMovePruning = false;
+            engine.useLateMoveReductions = false;
+            engine.parseFEN(fen);
+            int deepened = engine.searchBestMove(4).second;
+            engine.parseFEN(fen);
+            int direct = engine.negamax(4).second;
+            engine.transpositionTable = table;
+            engine.useNullMovePruning = true;
+            engine.useLateMoveReductions = true;
+
+            expect(deepened == direct);
+        });
+    });
+}
+
+void test_pruning() {
+    describe("Testing null move pruning and late move reductions", [&]() {
+        Engine engine;
+        engine.init();
+        std::string fen =
+            "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq "
+            "- 0 1";
+
+        it("Testing setoption NullMove and LMR", [&]() {
+            expect(engine.parseUCISetOption(
+                "setoption name NullMove value false"));
+            expect(!engine.useNullMovePruning);
+            expect(engine.parseUCISetOption("setoption name LMR value false"));
+            expect(!engine.useLateMoveReductions);
+            expect(!engine.parseUCISetOption("setoption name LMR value 1"));
+        });
+
+        it("Testing disabled features are never tried", [&]() {
+            engine.parseFEN(fen);
+            engine.searchBestMove(5);
+            expect(engine.stats.nullMoveTries == 0);
+            expect(engine.stats.lateMoveReductions == 0);
+        });
+
+        it("Testing both features cut the tree", [&]() {
+            engine.parseFEN(fen);
+            engine.transpositionTable->clear();
+            engine.searchBestMove(6);
+            uint64_t plainNodes = engine.nodes;
+
+            engine.useNullMovePruning = true;
+            engine.useLateMoveReductions = true;
+            engine.parseFEN(fen);
+            engine.transpositionTable->clear();
+            engine.searchBestMove(6);
+
+            expect(engine.nodes < plainNodes);
+            expect(engine.stats.nullMoveCutoffs > 0);
+            expect(engine.stats.nullMoveCutoffs <= engine.stats.nullMoveTries);
+            expect(engine.stats.lateMoveResearches <=
+                   engine.stats.lateMoveReductions);
+        });
+
+        it("Testing no null move with pawns only", [&]() {
+            engine.parseFEN("8/4k3/4p3/4P3/3K4/8/8/8 w - - 0 1");
+            engine.searchBestMove(8);
+            expect(engine.stats.nullMoveTries == 0);
+        });
+
+        it("Testing mates are still found", [&]() {
+            engine.parseFEN("6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+            auto result = engine.searchBestMove(5);
+            expect(result.first.toStringUCI() == "a1a8");
+            expect(result.second > MATE_BOUND);
+        });
+    });
+}
+
+void run_search_tests() {
+    describe("Testing search", []() {
+        test_transposition_table();
+        test_search_with_transposition_table();
+        test_time_manager();
+        test_iterative_deepening();
+        test_search_signals();
+        test_lazy_smp();
+        test_move_picker();
+        test_static_exchange_evaluation();
+        test_quiescence();
+        test_history_heuristic();
+        test_principal_variation();
+        test_pruning();
+    });
+}
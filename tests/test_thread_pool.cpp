@@ -0,0 +1,56 @@
+#include <atomic>
+#include <vector>
+
+#include "../src/lib/thread-pool/thread-pool.h"
+#include "test_lib.h"
+
+void run_thread_pool_tests() {
+    describe("Testing thread pool", []() {
+        it("Testing every task runs once", []() {
+            ThreadPool pool(4);
+            std::vector<int> runs(1000, 0);
+
+            for (size_t index = 0; index < runs.size(); index++) {
+                pool.enqueue([&runs, index](size_t) { runs[index]++; });
+            }
+            pool.wait();
+
+            bool allOnce = true;
+            for (int count : runs) {
+                allOnce = allOnce && count == 1;
+            }
+            expect(allOnce);
+        });
+
+        it("Testing worker indexes are in range", []() {
+            ThreadPool pool(3);
+            std::atomic<bool> inRange{true};
+
+            for (int index = 0; index < 100; index++) {
+                pool.enqueue([&](size_t workerIndex) {
+                    if (workerIndex >= pool.size()) {
+                        inRange = false;
+                    }
+                });
+            }
+            pool.wait();
+            expect(inRange);
+        });
+
+        it("Testing wait can be called again after more tasks", []() {
+            ThreadPool pool(2);
+            std::atomic<int> counter{0};
+
+            pool.enqueue([&](size_t) { counter++; });
+            pool.wait();
+            pool.enqueue([&](size_t) { counter++; });
+            pool.wait();
+            expect(counter == 2);
+        });
+
+        it("Testing zero workers falls back to one", []() {
+            ThreadPool pool(0);
+            expect(pool.size() == 1);
+        });
+    });
+}